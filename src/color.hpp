@@ -10,6 +10,11 @@ struct ColorRGBA {
     };
 };
 
+inline bool operator==(const ColorRGBA& a, const ColorRGBA& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+inline bool operator!=(const ColorRGBA& a, const ColorRGBA& b) { return !(a == b); }
+
 namespace COLOR {
 inline constexpr ColorRGBA RED = {1.0f, 0.0f, 0.0f, 1.0f};
 inline constexpr ColorRGBA GREEN = {0.0f, 1.0f, 0.0f, 1.0f};
@@ -0,0 +1,300 @@
+#define CLASS_NAME "CompiledScene"
+#include "log_macros.hpp"
+
+#include "compiled_scene.hpp"
+#include "mesh_buffer.hpp"
+
+bool CompiledScene::open(const std::string& filepath) {
+    close();
+
+    if (!file.open(filepath))
+        return false;
+
+    if (!validate(filepath)) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void CompiledScene::close() {
+    file.close();
+    worldObjects = nullptr;
+    worldObjectCount = 0;
+    componentStream = nullptr;
+    componentStreamSize = 0;
+    stringOffsets = nullptr;
+    stringData = nullptr;
+    stringCount = 0;
+    meshChunk = BulkChunk{};
+    meshes = nullptr;
+    meshCount = 0;
+    textureChunk = BulkChunk{};
+    textures = nullptr;
+    textureCount = 0;
+    textureLevels = nullptr;
+}
+
+bool CompiledScene::validate(const std::string& filepath) {
+    const uint8_t* data = file.getData();
+    size_t dataSize = file.getSize();
+
+    if (dataSize < sizeof(SceneFileHeader)) {
+        LOG_ERROR("Scene file is truncated: " + filepath);
+        return false;
+    }
+
+    auto header = reinterpret_cast<const SceneFileHeader*>(data);
+    if (header->magic != SCENE_MAGIC) {
+        LOG_ERROR("Invalid scene magic: " + filepath);
+        return false;
+    }
+    if (header->version != SCENE_FORMAT_VERSION) {
+        LOG_ERROR("Unsupported scene version " + std::to_string(header->version) + " (expected " +
+                  std::to_string(SCENE_FORMAT_VERSION) + "): " + filepath);
+        return false;
+    }
+
+    size_t directorySize = header->chunkCount * sizeof(SceneChunkEntry);
+    if (header->fileSize != dataSize || sizeof(SceneFileHeader) + directorySize > dataSize) {
+        LOG_ERROR("Scene file size mismatch: " + filepath);
+        return false;
+    }
+
+    const uint8_t* directory = data + sizeof(SceneFileHeader);
+    if (sceneChecksum(directory, directorySize) != header->directoryChecksum) {
+        LOG_ERROR("Scene chunk directory checksum mismatch: " + filepath);
+        return false;
+    }
+
+    auto chunks = reinterpret_cast<const SceneChunkEntry*>(directory);
+    for (uint16_t i = 0; i < header->chunkCount; i++) {
+        const auto& chunk = chunks[i];
+        if (chunk.offset > dataSize || chunk.size > dataSize - chunk.offset ||
+            chunk.offset % SCENE_CHUNK_ALIGNMENT != 0) {
+            LOG_ERROR("Scene chunk #" + std::to_string(i) + " is out of bounds: " + filepath);
+            return false;
+        }
+        if (!isBulkChunk(chunk.type) &&
+            sceneChecksum(data + chunk.offset, chunk.size) != chunk.checksum) {
+            LOG_ERROR("Scene chunk #" + std::to_string(i) + " checksum mismatch: " + filepath);
+            return false;
+        }
+    }
+
+    auto objectsChunk = findChunk(SceneChunkType::OBJECTS);
+    auto componentsChunk = findChunk(SceneChunkType::COMPONENTS);
+    auto stringsChunk = findChunk(SceneChunkType::STRINGS);
+    if (!objectsChunk || !componentsChunk || !stringsChunk) {
+        LOG_ERROR("Scene file is missing required chunks: " + filepath);
+        return false;
+    }
+    if (objectsChunk->size % sizeof(WorldObjectData) != 0) {
+        LOG_ERROR("Scene object table has an invalid size: " + filepath);
+        return false;
+    }
+    if (!validateStrings(data + stringsChunk->offset, stringsChunk->size)) {
+        LOG_ERROR("Scene string table is malformed: " + filepath);
+        return false;
+    }
+
+    // Scenes without mesh renderers have no MESHES chunk
+    meshChunk.entry = findChunk(SceneChunkType::MESHES);
+    if (meshChunk.entry &&
+        !validateMeshes(data + meshChunk.entry->offset, meshChunk.entry->size)) {
+        LOG_ERROR("Scene mesh table is malformed: " + filepath);
+        return false;
+    }
+
+    textureChunk.entry = findChunk(SceneChunkType::TEXTURES);
+    if (textureChunk.entry &&
+        !validateTextures(data + textureChunk.entry->offset, textureChunk.entry->size)) {
+        LOG_ERROR("Scene texture table is malformed: " + filepath);
+        return false;
+    }
+
+    worldObjects = reinterpret_cast<const WorldObjectData*>(data + objectsChunk->offset);
+    worldObjectCount = static_cast<uint32_t>(objectsChunk->size / sizeof(WorldObjectData));
+    componentStream = data + componentsChunk->offset;
+    componentStreamSize = componentsChunk->size;
+
+    return true;
+}
+
+bool CompiledScene::validateStrings(const uint8_t* chunk, uint64_t chunkSize) {
+    if (chunkSize < sizeof(uint32_t))
+        return false;
+
+    uint32_t count = *reinterpret_cast<const uint32_t*>(chunk);
+    uint64_t headerSize = sizeof(uint32_t) + static_cast<uint64_t>(count) * sizeof(uint32_t);
+    if (headerSize > chunkSize)
+        return false;
+
+    auto offsets = reinterpret_cast<const uint32_t*>(chunk + sizeof(uint32_t));
+    auto characters = reinterpret_cast<const char*>(chunk + headerSize);
+    uint64_t characterCount = chunkSize - headerSize;
+
+    // Every string must start inside the data block, and the block must end with a
+    // terminator, so no lookup can run past the chunk
+    if (count > 0 && (characterCount == 0 || characters[characterCount - 1] != '\0'))
+        return false;
+    for (uint32_t i = 0; i < count; i++) {
+        if (offsets[i] >= characterCount)
+            return false;
+    }
+
+    stringOffsets = offsets;
+    stringData = characters;
+    stringCount = count;
+    return true;
+}
+
+bool CompiledScene::validateMeshes(const uint8_t* chunk, uint64_t chunkSize) {
+    if (chunkSize < sizeof(MeshChunkHeader))
+        return false;
+
+    auto header = reinterpret_cast<const MeshChunkHeader*>(chunk);
+    if (header->meshCount > (chunkSize - sizeof(MeshChunkHeader)) / sizeof(BakedMeshData))
+        return false;
+
+    // Only the table is inspected here; the vertex data stays untouched until it is used
+    auto table = reinterpret_cast<const BakedMeshData*>(header + 1);
+    for (uint32_t i = 0; i < header->meshCount; i++) {
+        uint64_t verticesSize =
+            static_cast<uint64_t>(table[i].vertexCount) * table[i].vertexStride;
+        if (table[i].vertexStride != VertexLayout::positionNormal().stride ||
+            table[i].verticesOffset % alignof(float) != 0 ||
+            table[i].verticesOffset > chunkSize || verticesSize > chunkSize - table[i].verticesOffset)
+            return false;
+
+        auto indexType = static_cast<IndexType>(table[i].indexType);
+        if (indexType == IndexType::NONE)
+            continue;
+        if (indexType != IndexType::UINT16 && indexType != IndexType::UINT32)
+            return false;
+        uint64_t indicesSize = static_cast<uint64_t>(table[i].indexCount) * getIndexSize(indexType);
+        if (table[i].indicesOffset % getIndexSize(indexType) != 0 ||
+            table[i].indicesOffset > chunkSize ||
+            indicesSize > chunkSize - table[i].indicesOffset)
+            return false;
+    }
+
+    meshes = table;
+    meshCount = header->meshCount;
+    return true;
+}
+
+bool CompiledScene::validateTextures(const uint8_t* chunk, uint64_t chunkSize) {
+    if (chunkSize < sizeof(TextureChunkHeader))
+        return false;
+
+    auto header = reinterpret_cast<const TextureChunkHeader*>(chunk);
+    uint64_t tablesSize = static_cast<uint64_t>(header->textureCount) * sizeof(BakedTextureData) +
+                          static_cast<uint64_t>(header->levelCount) * sizeof(BakedTextureLevel);
+    if (tablesSize > chunkSize - sizeof(TextureChunkHeader))
+        return false;
+
+    auto table = reinterpret_cast<const BakedTextureData*>(header + 1);
+    auto levels = reinterpret_cast<const BakedTextureLevel*>(table + header->textureCount);
+    for (uint32_t i = 0; i < header->textureCount; i++) {
+        if (table[i].format > static_cast<uint8_t>(TextureFormat::BC3) ||
+            table[i].levelCount == 0 || table[i].levelCount > TEXTURE_MAX_LEVELS ||
+            table[i].firstLevel > header->levelCount ||
+            table[i].levelCount > header->levelCount - table[i].firstLevel)
+            return false;
+    }
+    for (uint32_t i = 0; i < header->levelCount; i++) {
+        if (levels[i].offset > chunkSize || levels[i].size > chunkSize - levels[i].offset)
+            return false;
+    }
+
+    textures = table;
+    textureCount = header->textureCount;
+    textureLevels = levels;
+    return true;
+}
+
+bool CompiledScene::verifyBulkChunk(const BulkChunk& chunk) const {
+    if (!chunk.verified) {
+        const uint8_t* data = file.getData() + chunk.entry->offset;
+        chunk.valid = sceneChecksum(data, chunk.entry->size) == chunk.entry->checksum;
+        chunk.verified = true;
+        if (!chunk.valid)
+            LOG_ERROR("Scene chunk checksum mismatch (type " +
+                      std::to_string(static_cast<uint32_t>(chunk.entry->type)) + ")");
+    }
+    return chunk.valid;
+}
+
+bool CompiledScene::isBulkChunk(SceneChunkType type) {
+    return type == SceneChunkType::MESHES || type == SceneChunkType::TEXTURES;
+}
+
+const BakedMeshData* CompiledScene::getMesh(uint32_t index) const {
+    if (index >= meshCount || !verifyBulkChunk(meshChunk))
+        return nullptr;
+    return &meshes[index];
+}
+
+const float* CompiledScene::getMeshVertices(const BakedMeshData& mesh) const {
+    return reinterpret_cast<const float*>(file.getData() + meshChunk.entry->offset +
+                                          mesh.verticesOffset);
+}
+
+const void* CompiledScene::getMeshIndices(const BakedMeshData& mesh) const {
+    if (static_cast<IndexType>(mesh.indexType) == IndexType::NONE)
+        return nullptr;
+    return file.getData() + meshChunk.entry->offset + mesh.indicesOffset;
+}
+
+const BakedTextureData* CompiledScene::getTexture(uint32_t index) const {
+    if (index >= textureCount || !verifyBulkChunk(textureChunk))
+        return nullptr;
+    return &textures[index];
+}
+
+bool CompiledScene::getTextureImage(uint32_t index, TextureImage& image) const {
+    auto texture = getTexture(index);
+    if (!texture)
+        return false;
+
+    const uint8_t* chunk = file.getData() + textureChunk.entry->offset;
+    image.format = static_cast<TextureFormat>(texture->format);
+    image.levelCount = texture->levelCount;
+    for (uint32_t i = 0; i < texture->levelCount; i++) {
+        const auto& level = textureLevels[texture->firstLevel + i];
+        image.levels[i] = TextureLevel{level.width, level.height, chunk + level.offset,
+                                       static_cast<uint32_t>(level.size)};
+    }
+    return true;
+}
+
+const char* CompiledScene::getString(uint32_t index) const {
+    if (index >= stringCount)
+        return nullptr;
+    return stringData + stringOffsets[index];
+}
+
+const SceneChunkEntry* CompiledScene::findChunk(SceneChunkType type) const {
+    auto header = reinterpret_cast<const SceneFileHeader*>(file.getData());
+    auto chunks =
+        reinterpret_cast<const SceneChunkEntry*>(file.getData() + sizeof(SceneFileHeader));
+    for (uint16_t i = 0; i < header->chunkCount; i++) {
+        if (chunks[i].type == type)
+            return &chunks[i];
+    }
+    return nullptr;
+}
+
+const ComponentHeader* CompiledScene::getComponent(uint32_t offset) const {
+    if (offset % alignof(ComponentHeader) != 0 || offset > componentStreamSize ||
+        componentStreamSize - offset < sizeof(ComponentHeader))
+        return nullptr;
+
+    auto header = reinterpret_cast<const ComponentHeader*>(componentStream + offset);
+    if (header->size > componentStreamSize - offset - sizeof(ComponentHeader))
+        return nullptr;
+
+    return header;
+}
@@ -0,0 +1,86 @@
+#ifndef COMPILED_SCENE_HPP
+#define COMPILED_SCENE_HPP
+
+#include "mapped_file.hpp"
+#include "scene_format.hpp"
+#include "texture_image.hpp"
+#include <cstdint>
+#include <string>
+
+// Read-only view over a mapped .scnb file. Records are read in place, so every
+// pointer handed out stays valid only until close() or the next open().
+class CompiledScene {
+  private:
+    // Bulk chunks are only checksummed the first time they are read, so a scene
+    // switch faults in just the pages that are actually used
+    struct BulkChunk {
+        const SceneChunkEntry* entry = nullptr;
+        mutable bool verified = false;
+        mutable bool valid = false;
+    };
+
+    MappedFile file;
+    const WorldObjectData* worldObjects = nullptr;
+    uint32_t worldObjectCount = 0;
+    const uint8_t* componentStream = nullptr;
+    uint64_t componentStreamSize = 0;
+    const uint32_t* stringOffsets = nullptr;
+    const char* stringData = nullptr;
+    uint32_t stringCount = 0;
+    BulkChunk meshChunk;
+    const BakedMeshData* meshes = nullptr;
+    uint32_t meshCount = 0;
+    BulkChunk textureChunk;
+    const BakedTextureData* textures = nullptr;
+    uint32_t textureCount = 0;
+    const BakedTextureLevel* textureLevels = nullptr;
+
+    bool validate(const std::string& filepath);
+    bool validateStrings(const uint8_t* chunk, uint64_t chunkSize);
+    bool validateMeshes(const uint8_t* chunk, uint64_t chunkSize);
+    bool validateTextures(const uint8_t* chunk, uint64_t chunkSize);
+    bool verifyBulkChunk(const BulkChunk& chunk) const;
+    static bool isBulkChunk(SceneChunkType type);
+    const SceneChunkEntry* findChunk(SceneChunkType type) const;
+
+  public:
+    CompiledScene() = default;
+    CompiledScene(const CompiledScene&) = delete;
+    CompiledScene& operator=(const CompiledScene&) = delete;
+
+    bool open(const std::string& filepath);
+    void close();
+    bool isOpen() const { return worldObjects != nullptr; }
+
+    uint32_t getWorldObjectCount() const { return worldObjectCount; }
+    const WorldObjectData& getWorldObject(uint32_t index) const { return worldObjects[index]; }
+
+    uint32_t getStringCount() const { return stringCount; }
+    // Returns nullptr for SCENE_INVALID_STRING or an out-of-range index
+    const char* getString(uint32_t index) const;
+
+    uint32_t getMeshCount() const { return meshCount; }
+    // Returns nullptr for an out-of-range index or when the MESHES chunk fails its checksum
+    const BakedMeshData* getMesh(uint32_t index) const;
+    // Interleaved float3 position + float3 normal, vertexStride bytes apart
+    const float* getMeshVertices(const BakedMeshData& mesh) const;
+    // Returns nullptr for non-indexed meshes
+    const void* getMeshIndices(const BakedMeshData& mesh) const;
+
+    uint32_t getTextureCount() const { return textureCount; }
+    // Returns nullptr for an out-of-range index or when the TEXTURES chunk fails its checksum
+    const BakedTextureData* getTexture(uint32_t index) const;
+    // Fills image with views of the baked levels; returns false when the texture is invalid
+    bool getTextureImage(uint32_t index, TextureImage& image) const;
+
+    // Returns nullptr when the record at offset does not fit inside the component stream
+    const ComponentHeader* getComponent(uint32_t offset) const;
+};
+
+template <typename T> const T* getComponentPayload(const ComponentHeader& header) {
+    if (header.size < sizeof(T))
+        return nullptr;
+    return reinterpret_cast<const T*>(&header + 1);
+}
+
+#endif
@@ -18,7 +18,9 @@ class Camera : public Component {
     float orthoSize = 1.0f;
 
   public:
-    Camera() = default;
+    static constexpr ComponentKind KIND = ComponentKind::CAMERA;
+
+    Camera() : Component(KIND) {}
     ~Camera() = default;
 
     ColorRGBA& getBackgroundColor();
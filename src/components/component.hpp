@@ -1,15 +1,28 @@
 #ifndef COMPONENT_HPP
 #define COMPONENT_HPP
 
+#include <cstdint>
+
 class WorldObject;
 
+// Tag for the built-in components, so lookups and scene registries can tell them apart
+// without RTTI. Other components keep OTHER and are found through dynamic_cast.
+enum class ComponentKind : uint8_t { OTHER, MESH_RENDERER, SPRITE_RENDERER, CAMERA, LIGHT };
+
 class Component {
+private:
+    ComponentKind kind;
+
 protected:
     WorldObject* owner = nullptr;
 
 public:
+    static constexpr ComponentKind KIND = ComponentKind::OTHER;
+
+    explicit Component(ComponentKind kind = ComponentKind::OTHER) : kind(kind) {}
     virtual ~Component() = default;
     
+    ComponentKind getKind() const { return kind; }
     void setOwner(WorldObject* obj) { owner = obj; }
     WorldObject* getOwner() const { return owner; }
 };
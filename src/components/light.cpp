@@ -14,4 +14,17 @@ const ColorRGBA& Light::getColor() const { return color; }
 
 void Light::setIntensity(float i) { intensity = i; }
 
-float Light::getIntensity() const { return intensity; }
\ No newline at end of file
+float Light::getIntensity() const { return intensity; }
+
+void Light::setRange(float r) { range = r; }
+
+float Light::getRange() const { return range; }
+
+void Light::setConeAngles(float inner, float outer) {
+    innerConeAngle = inner;
+    outerConeAngle = outer;
+}
+
+float Light::getInnerConeAngle() const { return innerConeAngle; }
+
+float Light::getOuterConeAngle() const { return outerConeAngle; }
\ No newline at end of file
@@ -14,9 +14,16 @@ class Light : public Component {
     Vector3 direction = {0.0f, -1.0f, 0.0f};
     ColorRGBA color = {1.0f, 1.0f, 1.0f, 1.0f};
     float intensity = 1.0f;
+    // POINT and SPOT lights sit at the owner's position and reach range units
+    float range = 10.0f;
+    // SPOT half angles in degrees: full intensity inside the inner cone, none outside the outer
+    float innerConeAngle = 30.0f;
+    float outerConeAngle = 45.0f;
 
   public:
-    Light() = default;
+    static constexpr ComponentKind KIND = ComponentKind::LIGHT;
+
+    Light() : Component(KIND) {}
 
     void setType(LightType t);
     LightType getType() const;
@@ -26,6 +33,11 @@ class Light : public Component {
     const ColorRGBA& getColor() const;
     void setIntensity(float i);
     float getIntensity() const;
+    void setRange(float r);
+    float getRange() const;
+    void setConeAngles(float inner, float outer);
+    float getInnerConeAngle() const;
+    float getOuterConeAngle() const;
 };
 
 #endif
@@ -10,7 +10,9 @@ class MeshRenderer : public Component {
     std::unique_ptr<Material> material;
 
   public:
-    MeshRenderer() = default;
+    static constexpr ComponentKind KIND = ComponentKind::MESH_RENDERER;
+
+    MeshRenderer() : Component(KIND) {}
     void setMaterial(std::unique_ptr<Material> m) { material = std::move(m); };
     Material* getMaterial() { return material.get(); }
     const Material* getMaterial() const { return material.get(); }
@@ -10,7 +10,9 @@ private:
     std::unique_ptr<Material> material;
 
 public:
-    SpriteRenderer() = default;
+    static constexpr ComponentKind KIND = ComponentKind::SPRITE_RENDERER;
+
+    SpriteRenderer() : Component(KIND) {}
     void setMaterial(std::unique_ptr<Material> m) { material = std::move(m); }
     Material* getMaterial() { return material.get(); }
     const Material* getMaterial() const { return material.get(); }
@@ -4,7 +4,6 @@
 
 #include "scene.hpp"
 #include "scene_manager.hpp"
-#include "stb_image_header.hpp"
 
 #include "logger.hpp"
 #include "timer.hpp"
@@ -122,7 +121,7 @@ void main_loop() {
             forward.y = -forward.y;
             forward.z = -forward.z;
 
-            Vector3 right = {cos(yawRad), 0.0f, -sin(yawRad)};
+            Vector3 right = {std::cos(yawRad), 0.0f, -std::sin(yawRad)};
 
             // Movimento WASD
             Vector3 delta = {0, 0, 0};
@@ -0,0 +1,121 @@
+#define CLASS_NAME "MappedFile"
+#include "log_macros.hpp"
+
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__EMSCRIPTEN__)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() { close(); }
+
+bool MappedFile::open(const std::string& filepath) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("Failed to open file: " + filepath);
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        LOG_ERROR("Failed to query file size (or file is empty): " + filepath);
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        LOG_ERROR("Failed to create file mapping: " + filepath);
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        LOG_ERROR("Failed to map file: " + filepath);
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const uint8_t*>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+#elif defined(__EMSCRIPTEN__)
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        LOG_ERROR("Failed to open file: " + filepath);
+        return false;
+    }
+
+    buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (buffer.empty() || !file.read(reinterpret_cast<char*>(buffer.data()), buffer.size())) {
+        LOG_ERROR("Failed to read file: " + filepath);
+        buffer.clear();
+        return false;
+    }
+
+    data = buffer.data();
+    size = buffer.size();
+#else
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open file: " + filepath);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        LOG_ERROR("Failed to query file size (or file is empty): " + filepath);
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file referenced; the descriptor is no longer needed
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        LOG_ERROR("Failed to map file: " + filepath);
+        return false;
+    }
+
+    data = static_cast<const uint8_t*>(view);
+    size = static_cast<size_t>(st.st_size);
+#endif
+
+    return true;
+}
+
+void MappedFile::close() {
+    if (!data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#elif defined(__EMSCRIPTEN__)
+    buffer.clear();
+    buffer.shrink_to_fit();
+#else
+    munmap(const_cast<uint8_t*>(data), size);
+#endif
+
+    data = nullptr;
+    size = 0;
+}
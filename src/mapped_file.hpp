@@ -0,0 +1,39 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef __EMSCRIPTEN__
+#include <vector>
+#endif
+
+// Read-only view of a whole file. Uses mmap / MapViewOfFile where available, so
+// pages are only faulted in when touched; falls back to reading the file on Emscripten.
+class MappedFile {
+  private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#elif defined(__EMSCRIPTEN__)
+    std::vector<uint8_t> buffer;
+#endif
+
+  public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filepath);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    const uint8_t* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
+
+#endif
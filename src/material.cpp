@@ -7,38 +7,16 @@
 
 Material::Material() {}
 
-bool Material::init() {
-    if (!vertexShader || !fragmentShader || !shaderProgram) {
-        return false;
-    }
-
-    if (!vertexShader->load() || !fragmentShader->load()) {
-        return false;
-    }
-
-    if (!shaderProgram->attachShader(*vertexShader) ||
-        !shaderProgram->attachShader(*fragmentShader)) {
-        return false;
-    }
-
-    if (!shaderProgram->link()) {
-        return false;
-    }
-
-    setBaseColor(baseColor);
-    return true;
-}
-
 void Material::use() {
     if (shaderProgram) {
         shaderProgram->use();
+        applyParameters();
     }
 }
 
-void Material::setBaseColor(const ColorRGBA color) {
-    baseColor = color;
+void Material::applyParameters() {
     if (shaderProgram) {
-        shaderProgram->setUniformBuffer("MaterialData", &baseColor, sizeof(baseColor));
+        shaderProgram->setUniformBuffer(UniformBlock::MATERIAL_DATA, &baseColor, sizeof(baseColor));
     }
 }
 
@@ -56,6 +34,6 @@ void Material::applyLight(const Light& light) {
             float intensity;
         } lightData = {light.getDirection(), 0.0f, light.getColor(), light.getIntensity()};
 
-        shaderProgram->setUniformBuffer("LightData", &lightData, sizeof(lightData));
+        shaderProgram->setUniformBuffer(UniformBlock::LIGHT_DATA, &lightData, sizeof(lightData));
     }
 }
\ No newline at end of file
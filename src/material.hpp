@@ -3,35 +3,37 @@
 
 #include "color.hpp"
 #include "components/light.hpp"
-#include "shader_asset.hpp"
 #include "shader_program.hpp"
+#include <cstdint>
 #include <memory>
 
+// Per-instance parameters on top of a linked program that may be shared with other
+// materials (see ShaderProgramCache)
 class Material {
   private:
-    std::unique_ptr<ShaderAsset> vertexShader;
-    std::unique_ptr<ShaderAsset> fragmentShader;
-    std::unique_ptr<ShaderProgram> shaderProgram;
+    static inline uint32_t nextId = 0;
+    uint32_t id = nextId++;
+    std::shared_ptr<ShaderProgram> shaderProgram;
     ColorRGBA baseColor = COLOR::RED;
 
   public:
     Material();
 
-    bool init();
+    // Unique per material, used to group draws in the render queue
+    uint32_t getId() const { return id; }
+
+    // Binds the program and uploads this instance's parameters
     void use();
-    void setBaseColor(const ColorRGBA color);
+    // Uploads this instance's parameters to the program, which must already be bound
+    void applyParameters();
+    void setBaseColor(const ColorRGBA color) { baseColor = color; }
+    const ColorRGBA& getBaseColor() const { return baseColor; }
     void applyLight(const Light& light);
 
-    void setVertexShader(std::unique_ptr<ShaderAsset> shader) { vertexShader = std::move(shader); }
-
-    void setFragmentShader(std::unique_ptr<ShaderAsset> shader) {
-        fragmentShader = std::move(shader);
-    }
-
     ShaderProgram* getShaderProgram() const { return shaderProgram.get(); }
-    void setShaderProgram(std::unique_ptr<ShaderProgram> program) {
+    void setShaderProgram(std::shared_ptr<ShaderProgram> program) {
         shaderProgram = std::move(program);
     }
 };
 
-#endif // MATERIAL_HPP
\ No newline at end of file
+#endif // MATERIAL_HPP
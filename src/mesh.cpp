@@ -1,17 +1,100 @@
 #include "mesh.hpp"
 #include <GL/glew.h>
+#include <algorithm>
+#include <cstring>
 
 bool Mesh::configure() {
-    bool result = meshBuffer->createBuffers(vertices, normals);
+    uint32_t count = static_cast<uint32_t>(vertices.size() / 3);
+    if (count > 0) {
+        bounds.min = bounds.max = {vertices[0], vertices[1], vertices[2]};
+        for (uint32_t i = 1; i < count; i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                bounds.min.v[axis] = std::min(bounds.min.v[axis], vertices[i * 3 + axis]);
+                bounds.max.v[axis] = std::max(bounds.max.v[axis], vertices[i * 3 + axis]);
+            }
+        }
+    }
 
-    return result;
+    MeshBufferDesc desc;
+    desc.vertexCount = count;
+    bool uploaded;
+    if (normals.size() != vertices.size()) {
+        desc.vertices = vertices.data();
+        desc.layout = VertexLayout::position();
+        uploaded = upload(desc);
+    } else {
+        std::vector<float> interleaved(vertices.size() * 2);
+        for (uint32_t i = 0; i < count; i++) {
+            std::copy_n(&vertices[i * 3], 3, &interleaved[i * 6]);
+            std::copy_n(&normals[i * 3], 3, &interleaved[i * 6 + 3]);
+        }
+        desc.vertices = interleaved.data();
+        desc.layout = VertexLayout::positionNormal();
+        uploaded = upload(desc);
+    }
+
+    if (residency == MeshResidency::GPU_ONLY)
+        releaseCpuCopy();
+    return uploaded;
+}
+
+bool Mesh::configure(const MeshBufferDesc& desc) {
+    if (!upload(desc))
+        return false;
+
+    if (residency == MeshResidency::KEEP_CPU_COPY)
+        copyFrom(desc);
+    return true;
+}
+
+bool Mesh::upload(const MeshBufferDesc& desc) {
+    if (!meshBuffer->createBuffers(desc))
+        return false;
+
+    vertexLayout = desc.layout;
+    vertexCount = desc.vertexCount;
+    indexCount = desc.indices ? desc.indexCount : 0;
+    indexType = desc.indices ? desc.indexType : IndexType::NONE;
+    return true;
+}
+
+void Mesh::copyFrom(const MeshBufferDesc& desc) {
+    auto source = static_cast<const uint8_t*>(desc.vertices);
+    auto position = desc.layout.find(VertexSemantic::POSITION);
+    auto normal = desc.layout.find(VertexSemantic::NORMAL);
+    if (normal && normal->format != VertexFormat::FLOAT3)
+        normal = nullptr;
+
+    vertices.resize(static_cast<size_t>(desc.vertexCount) * 3);
+    normals.resize(normal ? vertices.size() : 0);
+    for (uint32_t i = 0; i < desc.vertexCount && position; i++) {
+        const uint8_t* vertex = source + static_cast<size_t>(i) * desc.layout.stride;
+        std::memcpy(&vertices[i * 3], vertex + position->offset, 3 * sizeof(float));
+        if (normal)
+            std::memcpy(&normals[i * 3], vertex + normal->offset, 3 * sizeof(float));
+    }
+
+    indices.resize(indexCount);
+    for (uint32_t i = 0; i < indexCount; i++) {
+        if (indexType == IndexType::UINT16)
+            indices[i] = static_cast<const uint16_t*>(desc.indices)[i];
+        else
+            indices[i] = static_cast<const uint32_t*>(desc.indices)[i];
+    }
+}
+
+void Mesh::releaseCpuCopy() {
+    // clear() alone would keep the capacity allocated
+    std::vector<float>().swap(vertices);
+    std::vector<float>().swap(normals);
+    std::vector<uint32_t>().swap(indices);
 }
 
-void Mesh::setVertices(const std::vector<float>& v) { vertices = v; }
+void Mesh::setVertices(std::vector<float> v) { vertices = std::move(v); }
 
 const std::vector<float>& Mesh::getVertices() const { return vertices; }
 
-void Mesh::setNormals(const std::vector<float>& n) { normals = n; }
+void Mesh::setNormals(std::vector<float> n) { normals = std::move(n); }
 
 const std::vector<float>& Mesh::getNormals() const { return normals; }
 
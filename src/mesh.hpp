@@ -2,24 +2,62 @@
 #define MESH_HPP
 
 #include "mesh_buffer.hpp"
+#include "vector3.hpp"
+#include <cstdint>
 #include <memory>
 #include <vector>
 
+// What stays in system memory once a mesh has been uploaded
+enum class MeshResidency {
+    GPU_ONLY,     // CPU arrays are released after upload (default)
+    KEEP_CPU_COPY // positions/normals/indices stay readable, e.g. for picking or collision
+};
+
+struct Bounds {
+    Vector3 min;
+    Vector3 max;
+};
+
 class Mesh {
   private:
+    static inline uint32_t nextId = 0;
+    uint32_t id = nextId++;
     std::vector<float> vertices;
     std::vector<float> normals;
+    std::vector<uint32_t> indices;
     std::unique_ptr<MeshBuffer> meshBuffer;
+    MeshResidency residency = MeshResidency::GPU_ONLY;
+    VertexLayout vertexLayout;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    IndexType indexType = IndexType::NONE;
+    Bounds bounds{};
+
+    bool upload(const MeshBufferDesc& desc);
+    void copyFrom(const MeshBufferDesc& desc);
+    void releaseCpuCopy();
 
   public:
     Mesh() = default;
 
-    void setVertices(const std::vector<float>& v);
+    // Must be set before configure()
+    void setResidency(MeshResidency mode) { residency = mode; }
+    MeshResidency getResidency() const { return residency; }
+    bool hasCpuCopy() const { return !vertices.empty(); }
+
+    void setVertices(std::vector<float> v);
     const std::vector<float>& getVertices() const;
-    void setNormals(const std::vector<float>& n);
+    void setNormals(std::vector<float> n);
     const std::vector<float>& getNormals() const;
+    // Only filled for indexed meshes configured with KEEP_CPU_COPY
+    const std::vector<uint32_t>& getIndices() const { return indices; }
 
+    // Interleaves the vertices/normals set above (P3N3, or P3 without normals), uploads them
+    // and, unless KEEP_CPU_COPY was requested, releases them
     bool configure();
+    // Uploads external streams (e.g. a baked mesh inside a mapped scene); with KEEP_CPU_COPY
+    // the positions, normals and indices are then copied out of desc once the upload succeeds
+    bool configure(const MeshBufferDesc& desc);
     void bind();
     void unbind();
 
@@ -27,6 +65,16 @@ class Mesh {
     void* getMeshHandle() const;
     void* getMeshBufferHandle() const;
 
+    // Unique per mesh, used to group draws in the render queue
+    uint32_t getId() const { return id; }
+    const VertexLayout& getVertexLayout() const { return vertexLayout; }
+    uint32_t getVertexCount() const { return vertexCount; }
+    uint32_t getIndexCount() const { return indexCount; }
+    IndexType getIndexType() const { return indexType; }
+    bool isIndexed() const { return indexCount > 0; }
+    const Bounds& getBounds() const { return bounds; }
+    void setBounds(const Bounds& b) { bounds = b; }
+
     MeshBuffer* getMeshBuffer() const;
     void setMeshBuffer(std::unique_ptr<MeshBuffer> buffer);
 };
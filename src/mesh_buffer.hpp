@@ -1,13 +1,32 @@
 #ifndef MESH_BUFFER_HPP
 #define MESH_BUFFER_HPP
 
-#include <vector>
+#include "vertex_layout.hpp"
+#include <cstddef>
+#include <cstdint>
+
+enum class IndexType : uint8_t { NONE = 0, UINT16 = 1, UINT32 = 2 };
+
+inline size_t getIndexSize(IndexType type) {
+    return type == IndexType::UINT16 ? 2 : (type == IndexType::UINT32 ? 4 : 0);
+}
+
+// vertices holds vertexCount interleaved vertices described by layout.
+// Without indices (indexType NONE) the vertices are drawn as a plain triangle list.
+// The data is only read during createBuffers, so it can point straight into a mapped file.
+struct MeshBufferDesc {
+    const void* vertices = nullptr;
+    uint32_t vertexCount = 0;
+    VertexLayout layout;
+    const void* indices = nullptr;
+    uint32_t indexCount = 0;
+    IndexType indexType = IndexType::NONE;
+};
 
 class MeshBuffer {
   public:
     virtual ~MeshBuffer() = default;
-    virtual bool createBuffers(const std::vector<float>& vertices,
-                               const std::vector<float>& normals) = 0;
+    virtual bool createBuffers(const MeshBufferDesc& desc) = 0;
     virtual void bind() = 0;
     virtual void unbind() = 0;
     virtual void destroy() = 0;
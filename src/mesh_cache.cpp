@@ -0,0 +1,19 @@
+#include "mesh_cache.hpp"
+
+std::shared_ptr<Mesh> MeshCache::find(PathId path, bool shadeSmooth) const {
+    auto it = meshes.find(makeKey(path, shadeSmooth));
+    return it != meshes.end() ? it->second.lock() : nullptr;
+}
+
+void MeshCache::insert(PathId path, bool shadeSmooth, const std::shared_ptr<Mesh>& mesh) {
+    meshes[makeKey(path, shadeSmooth)] = mesh;
+}
+
+void MeshCache::purge() {
+    for (auto it = meshes.begin(); it != meshes.end();) {
+        if (it->second.expired())
+            it = meshes.erase(it);
+        else
+            ++it;
+    }
+}
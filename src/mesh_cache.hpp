@@ -0,0 +1,30 @@
+#ifndef MESH_CACHE_HPP
+#define MESH_CACHE_HPP
+
+#include "mesh.hpp"
+#include "path_table.hpp"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+// Shares uploaded meshes between every object that references the same (path, normal mode).
+// Entries are weak: a mesh is released as soon as the last object holding it goes away.
+class MeshCache {
+  private:
+    std::unordered_map<uint64_t, std::weak_ptr<Mesh>> meshes;
+
+    static uint64_t makeKey(PathId path, bool shadeSmooth) {
+        return (static_cast<uint64_t>(path) << 1) | (shadeSmooth ? 1u : 0u);
+    }
+
+  public:
+    // Returns nullptr when the mesh is not resident
+    std::shared_ptr<Mesh> find(PathId path, bool shadeSmooth) const;
+    void insert(PathId path, bool shadeSmooth, const std::shared_ptr<Mesh>& mesh);
+    // Drops entries whose mesh has already been released
+    void purge();
+
+    size_t size() const { return meshes.size(); }
+};
+
+#endif
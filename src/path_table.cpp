@@ -0,0 +1,18 @@
+#include "path_table.hpp"
+
+PathId PathTable::intern(const std::string& path) {
+    auto result = ids.try_emplace(path, static_cast<PathId>(paths.size()));
+    if (result.second)
+        paths.push_back(&result.first->first);
+    return result.first->second;
+}
+
+PathId PathTable::find(const std::string& path) const {
+    auto it = ids.find(path);
+    return it != ids.end() ? it->second : INVALID_PATH_ID;
+}
+
+const std::string& PathTable::getPath(PathId id) const {
+    static const std::string empty;
+    return id < paths.size() ? *paths[id] : empty;
+}
@@ -0,0 +1,28 @@
+#ifndef PATH_TABLE_HPP
+#define PATH_TABLE_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using PathId = uint32_t;
+inline constexpr PathId INVALID_PATH_ID = 0xFFFFFFFF;
+
+// Interns asset paths so the rest of the engine can compare them as integers.
+// Ids stay valid for the lifetime of the table, across scene loads.
+class PathTable {
+  private:
+    std::unordered_map<std::string, PathId> ids;
+    std::vector<const std::string*> paths;
+
+  public:
+    PathId intern(const std::string& path);
+    PathId find(const std::string& path) const;
+
+    // Returns an empty string for INVALID_PATH_ID or unknown ids
+    const std::string& getPath(PathId id) const;
+    size_t size() const { return paths.size(); }
+};
+
+#endif
@@ -7,11 +7,10 @@ D3D12MeshBuffer::~D3D12MeshBuffer() {
     destroy();
 }
 
-bool D3D12MeshBuffer::createBuffers(const std::vector<float>& vertices, const std::vector<float>& normals) {
+bool D3D12MeshBuffer::createBuffers(const MeshBufferDesc& desc) {
     auto device = backend->getDevice();
     
-    UINT vertexBufferSize = vertices.size() * sizeof(float);
-    UINT normalBufferSize = normals.size() * sizeof(float);
+    UINT vertexBufferSize = desc.vertexCount * desc.layout.stride;
     
     D3D12_HEAP_PROPERTIES heapProps = {};
     heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
@@ -32,27 +31,29 @@ bool D3D12MeshBuffer::createBuffers(const std::vector<float>& vertices, const st
     
     void* pData;
     vertexBuffer->Map(0, nullptr, &pData);
-    memcpy(pData, vertices.data(), vertexBufferSize);
+    memcpy(pData, desc.vertices, vertexBufferSize);
     vertexBuffer->Unmap(0, nullptr);
     
     vertexBufferView.BufferLocation = vertexBuffer->GetGPUVirtualAddress();
     vertexBufferView.SizeInBytes = vertexBufferSize;
-    vertexBufferView.StrideInBytes = 3 * sizeof(float);
+    vertexBufferView.StrideInBytes = desc.layout.stride;
     
-    if (!normals.empty()) {
-        bufferDesc.Width = normalBufferSize;
+    if (desc.indices && desc.indexCount > 0) {
+        UINT indexBufferSize = desc.indexCount * static_cast<UINT>(getIndexSize(desc.indexType));
+        bufferDesc.Width = indexBufferSize;
         if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc,
-            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&normalBuffer)))) {
+            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&indexBuffer)))) {
             return false;
         }
         
-        normalBuffer->Map(0, nullptr, &pData);
-        memcpy(pData, normals.data(), normalBufferSize);
-        normalBuffer->Unmap(0, nullptr);
+        indexBuffer->Map(0, nullptr, &pData);
+        memcpy(pData, desc.indices, indexBufferSize);
+        indexBuffer->Unmap(0, nullptr);
         
-        normalBufferView.BufferLocation = normalBuffer->GetGPUVirtualAddress();
-        normalBufferView.SizeInBytes = normalBufferSize;
-        normalBufferView.StrideInBytes = 3 * sizeof(float);
+        indexBufferView.BufferLocation = indexBuffer->GetGPUVirtualAddress();
+        indexBufferView.SizeInBytes = indexBufferSize;
+        indexBufferView.Format =
+            desc.indexType == IndexType::UINT16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
     }
     
     return true;
@@ -69,9 +70,9 @@ void D3D12MeshBuffer::destroy() {
         vertexBuffer->Release();
         vertexBuffer = nullptr;
     }
-    if (normalBuffer) {
-        normalBuffer->Release();
-        normalBuffer = nullptr;
+    if (indexBuffer) {
+        indexBuffer->Release();
+        indexBuffer = nullptr;
     }
 }
 
@@ -11,22 +11,22 @@ class D3D12MeshBuffer : public MeshBuffer {
 private:
     D3D12RendererBackend* backend;
     ID3D12Resource* vertexBuffer = nullptr;
-    ID3D12Resource* normalBuffer = nullptr;
+    ID3D12Resource* indexBuffer = nullptr;
     D3D12_VERTEX_BUFFER_VIEW vertexBufferView = {};
-    D3D12_VERTEX_BUFFER_VIEW normalBufferView = {};
+    D3D12_INDEX_BUFFER_VIEW indexBufferView = {};
     
 public:
     D3D12MeshBuffer(D3D12RendererBackend* backend) : backend(backend) {}
     ~D3D12MeshBuffer();
     
-    bool createBuffers(const std::vector<float>& vertices, const std::vector<float>& normals) override;
+    bool createBuffers(const MeshBufferDesc& desc) override;
     void bind() override;
     void unbind() override;
     void destroy() override;
     void* getHandle() const override;
     
     D3D12_VERTEX_BUFFER_VIEW* getVertexBufferView() { return &vertexBufferView; }
-    D3D12_VERTEX_BUFFER_VIEW* getNormalBufferView() { return &normalBufferView; }
+    D3D12_INDEX_BUFFER_VIEW* getIndexBufferView() { return &indexBufferView; }
 };
 
 #endif
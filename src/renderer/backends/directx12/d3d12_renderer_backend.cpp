@@ -255,10 +255,6 @@ bool D3D12RendererBackend::createConstantBuffers() {
         constantBuffers[i]->Map(0, nullptr, &constantBufferData[i]);
     }
 
-    uniformBindings["ModelViewProjection"] = 0;
-    uniformBindings["MaterialData"] = 1;
-    uniformBindings["LightData"] = 2;
-
     return true;
 }
 
@@ -307,11 +303,14 @@ void D3D12RendererBackend::clear(Camera* camera) {
 
 void D3D12RendererBackend::draw(const Mesh& mesh) {
     auto* d3d12Buffer = static_cast<D3D12MeshBuffer*>(mesh.getMeshBuffer());
-    D3D12_VERTEX_BUFFER_VIEW views[2] = {*d3d12Buffer->getVertexBufferView(),
-                                         *d3d12Buffer->getNormalBufferView()};
-    commandList->IASetVertexBuffers(0, 2, views);
+    commandList->IASetVertexBuffers(0, 1, d3d12Buffer->getVertexBufferView());
     commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    commandList->DrawInstanced(mesh.getVertices().size() / 3, 1, 0, 0);
+    if (mesh.isIndexed()) {
+        commandList->IASetIndexBuffer(d3d12Buffer->getIndexBufferView());
+        commandList->DrawIndexedInstanced(mesh.getIndexCount(), 1, 0, 0, 0);
+    } else {
+        commandList->DrawInstanced(mesh.getVertexCount(), 1, 0, 0);
+    }
 }
 
 void D3D12RendererBackend::setUniforms(ShaderProgram* shaderProgram) {
@@ -333,9 +332,9 @@ void D3D12RendererBackend::setUniforms(ShaderProgram* shaderProgram) {
     commandList->SetPipelineState(pipelineState);
     commandList->SetGraphicsRootSignature(rootSignature);
 
-    auto mvpAddr = program->getConstantBufferAddress("ModelViewProjection");
-    auto matAddr = program->getConstantBufferAddress("MaterialData");
-    auto lightAddr = program->getConstantBufferAddress("LightData");
+    auto mvpAddr = program->getConstantBufferAddress(UniformBlock::MODEL_VIEW_PROJECTION);
+    auto matAddr = program->getConstantBufferAddress(UniformBlock::MATERIAL_DATA);
+    auto lightAddr = program->getConstantBufferAddress(UniformBlock::LIGHT_DATA);
 
     if (mvpAddr)
         commandList->SetGraphicsRootConstantBufferView(0, mvpAddr);
@@ -386,6 +385,8 @@ void D3D12RendererBackend::bindCamera(Camera* camera) {
         glm::perspective(glm::radians(camera->getFov()), camera->getAspectRatio(),
                          camera->getNearDistance(), camera->getFarDistance());
 
+    setViewProjection(view, projection);
+
     struct {
         glm::mat4 model;
         glm::mat4 view;
@@ -397,9 +398,9 @@ void D3D12RendererBackend::bindCamera(Camera* camera) {
 
 void D3D12RendererBackend::setBufferDataImpl(const std::string& name, const void* data,
                                              size_t size) {
-    auto it = uniformBindings.find(name);
-    if (it != uniformBindings.end()) {
-        updateConstantBuffer(it->second, data, size);
+    UniformBlock block;
+    if (findUniformBlock(name.c_str(), block)) {
+        updateConstantBuffer(static_cast<int>(block), data, size);
     }
 }
 
@@ -409,7 +410,7 @@ void D3D12RendererBackend::updateConstantBuffer(int binding, const void* data, s
     }
 }
 
-unsigned int D3D12RendererBackend::createCubemapTexture(const std::vector<std::string>& faces) {
+unsigned int D3D12RendererBackend::createCubemapTexture(const std::array<TextureImage, 6>& faces) {
     return 0;
 }
 
@@ -442,33 +443,30 @@ void D3D12RendererBackend::applyMaterial(Material* material) {
     setUniforms(program);
 }
 
-void D3D12RendererBackend::renderWorldObjects(const std::vector<WorldObject*>& objects,
+void D3D12RendererBackend::renderWorldObjects(const RenderQueue& queue,
                                               const std::vector<Light*>& lights) {
-    for (auto* obj : objects) { // Remover const
-        auto mesh = obj->getMesh();
-        if (!mesh)
-            continue;
-
-        auto meshRenderer = obj->getComponent<MeshRenderer>();
-        if (!meshRenderer)
-            continue;
-
-        auto mat = meshRenderer->getMaterial(); // Agora retorna Material* não-const
-        if (!mat)
+    const Material* currentMaterial = nullptr;
+    for (size_t i = 0; i < queue.size(); i++) {
+        const auto& item = queue[i];
+        if (!item.mesh)
             continue;
 
-        mat->use();
-        applyMaterial(mat);
+        // Sorted by program then material: only rebind when the material changes
+        if (item.material != currentMaterial) {
+            item.material->use();
+            applyMaterial(item.material);
 
-        if (!lights.empty()) {
-            mat->applyLight(*lights[0]);
+            if (!lights.empty()) {
+                item.material->applyLight(*lights[0]);
+            }
+            currentMaterial = item.material;
         }
 
-        draw(*mesh);
+        draw(*item.mesh);
     }
 }
 
-unsigned int D3D12RendererBackend::loadTexture(const std::string& path, uint8_t filterType) {
+unsigned int D3D12RendererBackend::loadTexture(const TextureImage& image, uint8_t filterType) {
     return 0;
 };
 
@@ -5,7 +5,6 @@
 #include "../../renderer_backend.hpp"
 #include <d3d12.h>
 #include <dxgi1_6.h>
-#include <unordered_map>
 #include <vector>
 
 
@@ -28,7 +27,6 @@ class D3D12RendererBackend : public RendererBackend {
 
     ID3D12Resource* constantBuffers[3] = {};
     void* constantBufferData[3] = {};
-    std::unordered_map<std::string, int> uniformBindings;
 
     bool createDevice();
     bool createCommandQueue();
@@ -44,14 +42,13 @@ class D3D12RendererBackend : public RendererBackend {
   public:
     ~D3D12RendererBackend();
 
-    unsigned int loadTexture(const std::string& path, uint8_t filterType = 0) override;
+    unsigned int loadTexture(const TextureImage& image, uint8_t filterType = 0) override;
     void drawSprite(const Sprite& sprite) override;
     bool init() override;
     bool initWindowContext() override;
     void bindCamera(Camera* camera) override;
     void applyMaterial(Material* material) override;
-    void renderWorldObjects(const std::vector<WorldObject*>& objects,
-                            const std::vector<Light*>& lights) override;
+    void renderWorldObjects(const RenderQueue& queue, const std::vector<Light*>& lights) override;
     void clear(Camera* camera) override;
     void draw(const Mesh&) override;
     void setUniforms(ShaderProgram* shaderProgram) override;
@@ -61,7 +58,7 @@ class D3D12RendererBackend : public RendererBackend {
     void renderSkybox(const Mesh& mesh, unsigned int shaderProgram,
                       unsigned int textureID) override;
     void setBufferDataImpl(const std::string& name, const void* data, size_t size) override;
-    unsigned int createCubemapTexture(const std::vector<std::string>& faces) override;
+    unsigned int createCubemapTexture(const std::array<TextureImage, 6>& faces) override;
     std::unique_ptr<ShaderProgram> createShaderProgram() override;
     std::unique_ptr<ShaderCompiler> createShaderCompiler() override;
     std::unique_ptr<MeshBuffer> createMeshBuffer() override;
@@ -12,8 +12,8 @@ struct ShaderBytecode {
 };
 
 D3D12ShaderProgram::~D3D12ShaderProgram() {
-    for (auto& pair : constantBuffers) {
-        if (pair.second) pair.second->Release();
+    for (auto buffer : constantBuffers) {
+        if (buffer) buffer->Release();
     }
     if (pipelineState) pipelineState->Release();
     if (rootSignature) rootSignature->Release();
@@ -45,10 +45,6 @@ bool D3D12ShaderProgram::createPipeline() {
     rootParams[2].Descriptor.ShaderRegister = 2;
     rootParams[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
     
-    uniformBindings["ModelViewProjection"] = 0;
-    uniformBindings["MaterialData"] = 1;
-    uniformBindings["LightData"] = 2;
-
     D3D12_ROOT_SIGNATURE_DESC rootSigDesc = {};
     rootSigDesc.NumParameters = 3;
     rootSigDesc.pParameters = rootParams;
@@ -67,10 +63,19 @@ bool D3D12ShaderProgram::createPipeline() {
     }
     signature->Release();
     
-    D3D12_INPUT_ELEMENT_DESC inputLayout[] = {
-        {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-        {"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0}
-    };
+    // Every attribute reads from the single interleaved vertex buffer in slot 0
+    static const char* const semanticNames[] = {"POSITION", "NORMAL", "TEXCOORD", "TANGENT"};
+    D3D12_INPUT_ELEMENT_DESC inputLayout[VertexLayout::MAX_ATTRIBUTES] = {};
+    for (uint32_t i = 0; i < vertexLayout.attributeCount; i++) {
+        const auto& attribute = vertexLayout.attributes[i];
+        DXGI_FORMAT format = DXGI_FORMAT_R32G32B32_FLOAT;
+        if (attribute.format == VertexFormat::FLOAT2)
+            format = DXGI_FORMAT_R32G32_FLOAT;
+        else if (attribute.format == VertexFormat::FLOAT4)
+            format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+        inputLayout[i] = {semanticNames[static_cast<uint32_t>(attribute.semantic)], 0, format, 0,
+                          attribute.offset, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0};
+    }
     
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.pRootSignature = rootSignature;
@@ -84,7 +89,7 @@ bool D3D12ShaderProgram::createPipeline() {
         }
     }
     
-    psoDesc.InputLayout = {inputLayout, 2};
+    psoDesc.InputLayout = {inputLayout, vertexLayout.attributeCount};
     psoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
     psoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_BACK;
     psoDesc.RasterizerState.FrontCounterClockwise = TRUE;
@@ -111,14 +116,8 @@ bool D3D12ShaderProgram::createPipeline() {
 void D3D12ShaderProgram::use() {
 }
 
-void D3D12ShaderProgram::setUniformBuffer(const char* name, const void* data, size_t size) {
-    auto it = uniformBindings.find(name);
-    if (it == uniformBindings.end()) {
-        LOG_WARN("Uniform " + std::string(name) + " not found!");
-        return;
-    }
-
-    ID3D12Resource*& buffer = constantBuffers[name];
+void D3D12ShaderProgram::setUniformBuffer(UniformBlock block, const void* data, size_t size) {
+    ID3D12Resource*& buffer = constantBuffers[static_cast<uint32_t>(block)];
     if (buffer == nullptr) {
         D3D12_HEAP_PROPERTIES heapProps = {};
         heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
@@ -4,8 +4,6 @@
 #include "../../../shader_program.hpp"
 #include "../../../shader_type.hpp"
 #include <d3d12.h>
-#include <string>
-#include <unordered_map>
 #include <vector>
 
 class D3D12RendererBackend;
@@ -18,8 +16,7 @@ class D3D12ShaderProgram : public ShaderProgram {
     ID3D12PipelineState* pipelineState = nullptr;
     ID3D12RootSignature* rootSignature = nullptr;
 
-    std::unordered_map<std::string, int> uniformBindings;
-    std::unordered_map<std::string, ID3D12Resource*> constantBuffers;
+    ID3D12Resource* constantBuffers[UNIFORM_BLOCK_COUNT] = {};
 
     bool createPipeline();
 
@@ -30,13 +27,13 @@ class D3D12ShaderProgram : public ShaderProgram {
     bool attachShader(const ShaderAsset& shader) override;
     bool link() override;
     void use() override;
-    void setUniformBuffer(const char* name, const void* data, size_t size) override;
+    void setUniformBuffer(UniformBlock block, const void* data, size_t size) override;
     void* getHandle() const override;
     bool isValid() const override;
 
-    D3D12_GPU_VIRTUAL_ADDRESS getConstantBufferAddress(const char* name) const {
-        auto it = constantBuffers.find(name);
-        return (it != constantBuffers.end() && it->second) ? it->second->GetGPUVirtualAddress() : 0;
+    D3D12_GPU_VIRTUAL_ADDRESS getConstantBufferAddress(UniformBlock block) const {
+        auto buffer = constantBuffers[static_cast<uint32_t>(block)];
+        return buffer ? buffer->GetGPUVirtualAddress() : 0;
     }
 
     ID3D12PipelineState* getPipelineState() const { return pipelineState; }
@@ -8,24 +8,31 @@ void* OpenGLMeshBuffer::getHandle() const {
     return reinterpret_cast<void*>(VAO); 
 }
 
-bool OpenGLMeshBuffer::createBuffers(const std::vector<float>& vertices, const std::vector<float>& normals) {
+bool OpenGLMeshBuffer::createBuffers(const MeshBufferDesc& desc) {
     glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &positionVBO);
-    glGenBuffers(1, &normalVBO);
+    glGenBuffers(1, &vertexVBO);
 
     glBindVertexArray(VAO);
     
-    // Position buffer
-    glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Normal buffer
-    glBindBuffer(GL_ARRAY_BUFFER, normalVBO);
-    glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(float), normals.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    glEnableVertexAttribArray(1);
+    // Interleaved vertex buffer, one attribute pointer per layout entry
+    glBindBuffer(GL_ARRAY_BUFFER, vertexVBO);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(desc.vertexCount) * desc.layout.stride,
+                 desc.vertices, GL_STATIC_DRAW);
+    for (uint32_t i = 0; i < desc.layout.attributeCount; i++) {
+        const auto& attribute = desc.layout.attributes[i];
+        glVertexAttribPointer(attribute.location, getVertexFormatComponents(attribute.format),
+                              GL_FLOAT, GL_FALSE, desc.layout.stride,
+                              reinterpret_cast<void*>(static_cast<uintptr_t>(attribute.offset)));
+        glEnableVertexAttribArray(attribute.location);
+    }
+
+    // Index buffer (the binding is recorded in the VAO)
+    if (desc.indices && desc.indexCount > 0) {
+        glGenBuffers(1, &indexEBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, desc.indexCount * getIndexSize(desc.indexType),
+                     desc.indices, GL_STATIC_DRAW);
+    }
 
     glBindVertexArray(0);
     return true;
@@ -42,8 +49,8 @@ void OpenGLMeshBuffer::unbind() {
 void OpenGLMeshBuffer::destroy() {
     if (VAO != 0) {
         glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &positionVBO);
-        glDeleteBuffers(1, &normalVBO);
-        VAO = positionVBO = normalVBO = 0;
+        glDeleteBuffers(1, &vertexVBO);
+        glDeleteBuffers(1, &indexEBO);
+        VAO = vertexVBO = indexEBO = 0;
     }
 }
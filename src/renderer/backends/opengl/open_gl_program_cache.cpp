@@ -0,0 +1,113 @@
+#define CLASS_NAME "OpenGLProgramCache"
+#include "log_macros.hpp"
+
+#include "open_gl_program_cache.hpp"
+#include "renderer/shader_cache_file.hpp"
+#include <cstring>
+
+void OpenGLProgramCache::load() {
+    entries.clear();
+    dirty = false;
+
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    enabled = formatCount > 0;
+    if (!enabled) {
+        LOG_INFO("Program binaries are not supported; shaders are compiled on every run");
+        return;
+    }
+
+    driverHash = ShaderCacheFile::hash(nullptr, 0);
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const char* value = reinterpret_cast<const char*>(glGetString(name));
+        if (value)
+            driverHash = ShaderCacheFile::hash(value, std::strlen(value) + 1, driverHash);
+    }
+
+    std::vector<uint8_t> data;
+    if (!ShaderCacheFile::read(FILE_NAME, data))
+        return;
+
+    FileHeader header;
+    if (data.size() < sizeof(header))
+        return;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != MAGIC || header.version != VERSION) {
+        LOG_WARN(std::string(FILE_NAME) + " has an unknown format and is ignored");
+        return;
+    }
+
+    size_t offset = sizeof(header);
+    for (uint32_t i = 0; i < header.entryCount; i++) {
+        EntryHeader entry;
+        if (data.size() - offset < sizeof(entry))
+            break;
+        std::memcpy(&entry, data.data() + offset, sizeof(entry));
+        offset += sizeof(entry);
+        if (data.size() - offset < entry.binarySize)
+            break;
+        const uint8_t* binary = data.data() + offset;
+        entries[entry.key] = Entry{entry.format, {binary, binary + entry.binarySize}};
+        offset += entry.binarySize;
+    }
+    LOG_INFO("Loaded " + std::to_string(entries.size()) + " cached program binaries");
+}
+
+void OpenGLProgramCache::save() {
+    if (!enabled || !dirty)
+        return;
+
+    std::vector<uint8_t> data(sizeof(FileHeader));
+    FileHeader header{MAGIC, VERSION, static_cast<uint32_t>(entries.size()), 0};
+    std::memcpy(data.data(), &header, sizeof(header));
+    for (const auto& [key, entry] : entries) {
+        EntryHeader entryHeader{key, entry.format, static_cast<uint32_t>(entry.binary.size())};
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&entryHeader);
+        data.insert(data.end(), bytes, bytes + sizeof(entryHeader));
+        data.insert(data.end(), entry.binary.begin(), entry.binary.end());
+    }
+    if (ShaderCacheFile::write(FILE_NAME, data.data(), data.size()))
+        dirty = false;
+}
+
+uint64_t
+OpenGLProgramCache::makeKey(const std::vector<std::pair<GLenum, std::string>>& sources) const {
+    uint64_t key = driverHash;
+    for (const auto& [stage, source] : sources) {
+        key = ShaderCacheFile::hash(&stage, sizeof(stage), key);
+        key = ShaderCacheFile::hash(source.data(), source.size(), key);
+    }
+    return key;
+}
+
+bool OpenGLProgramCache::restore(GLuint program, uint64_t key) {
+    auto it = entries.find(key);
+    if (it == entries.end())
+        return false;
+
+    const Entry& entry = it->second;
+    glProgramBinary(program, entry.format, entry.binary.data(),
+                    static_cast<GLsizei>(entry.binary.size()));
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE) {
+        // Driver changed in a way the version strings did not show; relink and replace
+        entries.erase(it);
+        dirty = true;
+        return false;
+    }
+    return true;
+}
+
+void OpenGLProgramCache::store(GLuint program, uint64_t key) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    Entry entry;
+    entry.binary.resize(static_cast<size_t>(length));
+    glGetProgramBinary(program, length, nullptr, &entry.format, entry.binary.data());
+    entries[key] = std::move(entry);
+    dirty = true;
+}
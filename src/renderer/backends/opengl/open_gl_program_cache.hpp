@@ -0,0 +1,64 @@
+#ifndef OPEN_GL_PROGRAM_CACHE_HPP
+#define OPEN_GL_PROGRAM_CACHE_HPP
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Persistent cache of linked program binaries (glGetProgramBinary / glProgramBinary),
+// stored in ShaderCacheFile FILE_NAME. Keys hash the shader sources together with the
+// GL vendor, renderer and version strings, so a driver update misses instead of feeding
+// the driver a binary it may reject. A binary that is rejected anyway is dropped and the
+// program is linked from source as usual.
+//
+// Disabled when the driver reports no binary formats (no GL 4.1 / ARB_get_program_binary).
+class OpenGLProgramCache {
+  private:
+    static constexpr const char* FILE_NAME = "gl_programs.bin";
+    static constexpr uint32_t MAGIC = 0x42504C47; // "GLPB"
+    static constexpr uint32_t VERSION = 1;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t reserved;
+    };
+    // Followed by binarySize bytes of program binary
+    struct EntryHeader {
+        uint64_t key;
+        uint32_t format;
+        uint32_t binarySize;
+    };
+    struct Entry {
+        GLenum format;
+        std::vector<uint8_t> binary;
+    };
+
+    std::unordered_map<uint64_t, Entry> entries;
+    uint64_t driverHash = 0;
+    bool enabled = false;
+    bool dirty = false;
+
+  public:
+    OpenGLProgramCache() = default;
+    OpenGLProgramCache(const OpenGLProgramCache&) = delete;
+    OpenGLProgramCache& operator=(const OpenGLProgramCache&) = delete;
+
+    // Needs a current context
+    void load();
+    // Writes the file back if anything was added since load()
+    void save();
+    bool isEnabled() const { return enabled; }
+
+    // Key of a program built from sources, each hashed with its shader stage
+    uint64_t makeKey(const std::vector<std::pair<GLenum, std::string>>& sources) const;
+    // Loads the binary stored under key into program; true when it linked
+    bool restore(GLuint program, uint64_t key);
+    // Records the binary of a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    void store(GLuint program, uint64_t key);
+};
+
+#endif // OPEN_GL_PROGRAM_CACHE_HPP
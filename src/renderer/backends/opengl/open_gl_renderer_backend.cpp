@@ -5,9 +5,9 @@
 #include "../../../components/mesh_renderer.hpp"
 #include "../../../components/sprite_renderer.hpp"
 #include "../../../material.hpp"
-#include "../../../stb_image.h"
 #include "mesh_buffer_factory.hpp"
 #include "open_gl_renderer_backend.hpp"
+#include "open_gl_shader_program.hpp"
 #include "shader_compiler_factory.hpp"
 #include "shader_program_factory.hpp"
 #include <GL/glew.h>
@@ -15,24 +15,33 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 
 GraphicsAPI OpenGLRendererBackend::getGraphicsAPI() const { return GraphicsAPI::OPENGL; }
 
 std::string OpenGLRendererBackend::getShaderExtension() const { return ".glsl"; }
 
+// Initial region size, enough for a few thousand draws per frame with 256-byte UBO offset
+// alignment; the ring grows past it when a frame overflows
+static constexpr size_t UNIFORM_RING_FRAME_SIZE = 2 * 1024 * 1024;
+static constexpr GLuint MATRICES_BINDING = static_cast<GLuint>(UniformBlock::MODEL_VIEW_PROJECTION);
+static constexpr GLuint CLUSTER_LIGHTS_BINDING =
+    static_cast<GLuint>(UniformBlock::CLUSTER_LIGHT_DATA);
+
 OpenGLRendererBackend::~OpenGLRendererBackend() {
-    if (matricesUBO)
-        glDeleteBuffers(1, &matricesUBO);
-    if (materialDataUBO)
-        glDeleteBuffers(1, &materialDataUBO);
-    if (lightDataUBO)
-        glDeleteBuffers(1, &lightDataUBO);
+    programCache.save();
+    if (instanceVBO)
+        glDeleteBuffers(1, &instanceVBO);
+    deleteTextureBuffer(clusterGrid);
+    deleteTextureBuffer(clusterLightIndices);
 }
 
 unsigned int OpenGLRendererBackend::getRequiredWindowFlags() const { return SDL_WINDOW_OPENGL; };
 
 std::unique_ptr<ShaderProgram> OpenGLRendererBackend::createShaderProgram() {
-    return ShaderProgramFactory::create(getGraphicsAPI());
+    return ShaderProgramFactory::create(getGraphicsAPI(), this);
 }
 
 std::unique_ptr<MeshBuffer> OpenGLRendererBackend::createMeshBuffer() {
@@ -66,36 +75,36 @@ bool OpenGLRendererBackend::init() {
         return false;
     }
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    glGenBuffers(1, &matricesUBO);
-    glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
-    glBufferData(GL_UNIFORM_BUFFER, 4 * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_UNIFORM_BUFFER, 0, matricesUBO);
-
-    glGenBuffers(1, &materialDataUBO);
-    glBindBuffer(GL_UNIFORM_BUFFER, materialDataUBO);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_UNIFORM_BUFFER, 1, materialDataUBO);
-
-    glGenBuffers(1, &lightDataUBO);
-    glBindBuffer(GL_UNIFORM_BUFFER, lightDataUBO);
-    glBufferData(GL_UNIFORM_BUFFER, 256, nullptr, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_UNIFORM_BUFFER, 2, lightDataUBO);
+    programCache.load();
+    parallelShaderCompile = GLEW_KHR_parallel_shader_compile;
+    if (parallelShaderCompile) {
+        // Let the driver pick the number of compiler threads
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+    }
 
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    state.setDepthTest(true);
+    state.setBlend(true);
+    state.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    uniformBindings["ModelViewProjection"] = matricesUBO;
-    uniformBindings["MaterialData"] = materialDataUBO;
-    uniformBindings["LightData"] = lightDataUBO;
+    if (!uniformRing.init(UNIFORM_RING_FRAME_SIZE, state)) {
+        LOG_ERROR("Failed to create the uniform ring buffer");
+        return false;
+    }
 
     initSpriteQuad();
+    if (!spriteBatcher.init(state))
+        return false;
 
     return true;
 }
 
+void OpenGLRendererBackend::beginFrame() {
+    // Resources created between frames bind through raw GL
+    state.beginFrame();
+    state.invalidate();
+    uniformRing.beginFrame();
+}
+
 void OpenGLRendererBackend::onCameraSet() {}
 
 void OpenGLRendererBackend::clear(Camera* camera) {
@@ -114,10 +123,16 @@ bool OpenGLRendererBackend::initWindowContext() {
 }
 
 void OpenGLRendererBackend::draw(const Mesh& mesh) {
+    // The VAO is left bound so consecutive draws of the same mesh skip the rebind
     auto vao = static_cast<GLuint>(reinterpret_cast<uintptr_t>(mesh.getMeshBufferHandle()));
-    glBindVertexArray(vao);
-    glDrawArrays(GL_TRIANGLES, 0, mesh.getVertices().size() / 3);
-    glBindVertexArray(0);
+    state.bindVertexArray(vao);
+    if (mesh.isIndexed()) {
+        GLenum indexType =
+            mesh.getIndexType() == IndexType::UINT16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        glDrawElements(GL_TRIANGLES, mesh.getIndexCount(), indexType, nullptr);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, mesh.getVertexCount());
+    }
 }
 
 void OpenGLRendererBackend::setUniforms(ShaderProgram* shaderProgram) {
@@ -139,8 +154,6 @@ void OpenGLRendererBackend::bindCamera(Camera* camera) {
         return;
     }
 
-    glm::mat4 model = glm::mat4(1.0f);
-
     const auto camPos = cameraObj->getTransform().getPosition();
     const auto camRot = cameraObj->getTransform().getRotation();
 
@@ -173,22 +186,18 @@ void OpenGLRendererBackend::bindCamera(Camera* camera) {
                                       camera->getNearDistance(), camera->getFarDistance());
     }
 
-    glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(model));
-    glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(view));
-    glBufferSubData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), sizeof(glm::mat4),
-                    glm::value_ptr(projection));
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    setViewProjection(view, projection);
+
+    // Per-draw blocks reuse these; the identity model serves instanced draws
+    matrices = MatricesBlock{glm::mat4(1.0f), view, projection};
+    uniformRing.bind(MATRICES_BINDING, &matrices, sizeof(matrices));
 }
 
 void OpenGLRendererBackend::setBufferDataImpl(const std::string& name, const void* data,
                                               size_t size) {
-    auto it = uniformBindings.find(name);
-    if (it != uniformBindings.end()) {
-        glBindBuffer(GL_UNIFORM_BUFFER, it->second);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
-    }
+    UniformBlock block;
+    if (findUniformBlock(name.c_str(), block))
+        uniformRing.bind(static_cast<GLuint>(block), data, size);
 }
 
 void OpenGLRendererBackend::applyMaterial(Material* material) {
@@ -200,68 +209,235 @@ void OpenGLRendererBackend::applyMaterial(Material* material) {
     setUniforms(program);
 }
 
-void OpenGLRendererBackend::renderWorldObjects(const std::vector<WorldObject*>& objects,
-                                               const std::vector<Light*>& lights) {
-    for (auto* obj : objects) { // Remover const
-        glm::mat4 model = obj->getTransform().getModelMatrix();
-
-        glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(model));
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-        if (obj->hasSprite()) {
-            auto sprite = obj->getSprite();
-            auto spriteRenderer = obj->getComponent<SpriteRenderer>();
-
-            if (spriteRenderer) {
-                auto mat = spriteRenderer->getMaterial();
-                if (mat) {
-                    mat->use();
-                    applyMaterial(mat);
-                    drawSprite(*sprite);
-                }
+bool OpenGLRendererBackend::canBatchSprites(const RenderItem& first, const RenderItem& item) {
+    // Every scene sprite owns its material, so equal parameters are what has to match
+    return item.sprite && item.sprite->getTexture() == first.sprite->getTexture() &&
+           item.material->getShaderProgram() == first.material->getShaderProgram() &&
+           item.material->getBaseColor() == first.material->getBaseColor();
+}
+
+void OpenGLRendererBackend::buildBatches(const RenderQueue& queue) {
+    batches.clear();
+    instanceData.clear();
+    spriteBatcher.clear();
+
+    for (size_t i = 0; i < queue.size();) {
+        const auto& item = queue[i];
+        auto program = static_cast<const OpenGLShaderProgram*>(item.material->getShaderProgram());
+
+        // The queue keeps equal (program, mesh) pairs and equal-depth sprites sharing a
+        // texture adjacent, so a run is just a scan
+        size_t end = i + 1;
+        BatchKind kind = BatchKind::SINGLE;
+        size_t firstElement = 0;
+        if (item.sprite) {
+            kind = BatchKind::SPRITES;
+            while (end < queue.size() && canBatchSprites(item, queue[end]))
+                end++;
+            for (size_t j = i; j < end; j++) {
+                uint32_t quad = spriteBatcher.add(queue[j].object->getTransform().getModelMatrix(),
+                                                  *queue[j].sprite);
+                if (j == i)
+                    firstElement = quad;
             }
-        } else if (obj->hasMesh()) {
-            auto mesh = obj->getMesh();
-            auto meshRenderer = obj->getComponent<MeshRenderer>();
-
-            if (meshRenderer) {
-                auto mat = meshRenderer->getMaterial();
-                if (mat) {
-                    mat->use();
-                    applyMaterial(mat);
-                    if (!lights.empty()) {
-                        mat->applyLight(*lights[0]);
-                    }
-                    draw(*mesh);
-                }
+        } else if (program && program->usesInstancing()) {
+            // Materials may differ: their base color travels with each instance
+            kind = BatchKind::INSTANCED;
+            while (end < queue.size() && queue[end].mesh == item.mesh &&
+                   queue[end].material->getShaderProgram() == program)
+                end++;
+            firstElement = instanceData.size();
+            for (size_t j = i; j < end; j++) {
+                instanceData.push_back(InstanceData{
+                    queue[j].object->getTransform().getModelMatrix(),
+                    queue[j].material->getBaseColor()});
             }
         }
+
+        batches.push_back(DrawBatch{i, end - i, firstElement, kind});
+        i = end;
+    }
+}
+
+void OpenGLRendererBackend::uploadInstanceData() {
+    if (instanceData.empty())
+        return;
+
+    size_t size = instanceData.size() * sizeof(InstanceData);
+    if (!instanceVBO)
+        glGenBuffers(1, &instanceVBO);
+
+    if (size > instanceVBOCapacity)
+        instanceVBOCapacity = size + size / 2;
+
+    // Orphan last frame's storage instead of waiting for the GPU to finish reading it
+    state.bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instanceVBOCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, instanceData.data());
+}
+
+void OpenGLRendererBackend::drawInstanced(const Mesh& mesh, size_t firstInstance,
+                                          size_t instanceCount) {
+    auto vao = static_cast<GLuint>(reinterpret_cast<uintptr_t>(mesh.getMeshBufferHandle()));
+    state.bindVertexArray(vao);
+
+    // Point the mesh VAO's instance inputs at this batch's slice of instanceVBO
+    const GLsizei stride = sizeof(InstanceData);
+    const size_t base = firstInstance * sizeof(InstanceData);
+    state.bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (GLuint column = 0; column < 4; column++) {
+        GLuint location = OpenGLShaderProgram::INSTANCE_MODEL_LOCATION + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<void*>(base + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(location, 1);
+    }
+    glEnableVertexAttribArray(OpenGLShaderProgram::INSTANCE_COLOR_LOCATION);
+    glVertexAttribPointer(OpenGLShaderProgram::INSTANCE_COLOR_LOCATION, 4, GL_FLOAT, GL_FALSE,
+                          stride,
+                          reinterpret_cast<void*>(base + offsetof(InstanceData, color)));
+    glVertexAttribDivisor(OpenGLShaderProgram::INSTANCE_COLOR_LOCATION, 1);
+
+    GLsizei count = static_cast<GLsizei>(instanceCount);
+    if (mesh.isIndexed()) {
+        GLenum indexType =
+            mesh.getIndexType() == IndexType::UINT16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        glDrawElementsInstanced(GL_TRIANGLES, mesh.getIndexCount(), indexType, nullptr, count);
+    } else {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, mesh.getVertexCount(), count);
+    }
+}
+
+void OpenGLRendererBackend::uploadTextureBuffer(TextureBuffer& target, GLenum format,
+                                                const void* data, size_t size) {
+    if (!target.buffer) {
+        glGenBuffers(1, &target.buffer);
+        glGenTextures(1, &target.texture);
+    }
+
+    // Never empty, so the texture always has storage to fetch from
+    size = std::max<size_t>(size, sizeof(uint32_t) * 2);
+    bool grown = size > target.capacity;
+    if (grown)
+        target.capacity = size + size / 2;
+
+    // Orphan last frame's storage; the texture keeps pointing at the buffer object
+    state.bindBuffer(GL_TEXTURE_BUFFER, target.buffer);
+    glBufferData(GL_TEXTURE_BUFFER, target.capacity, nullptr, GL_STREAM_DRAW);
+    if (data)
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+
+    if (grown) {
+        state.bindTexture(0, GL_TEXTURE_BUFFER, target.texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, target.buffer);
+    }
+}
+
+void OpenGLRendererBackend::deleteTextureBuffer(TextureBuffer& target) {
+    if (target.texture) {
+        glDeleteTextures(1, &target.texture);
+        state.onTextureDeleted(target.texture);
+    }
+    if (target.buffer) {
+        glDeleteBuffers(1, &target.buffer);
+        state.onBufferDeleted(target.buffer);
+    }
+    target = TextureBuffer();
+}
+
+bool OpenGLRendererBackend::supportsLightClusters() const { return true; }
+
+void OpenGLRendererBackend::uploadLightClusters(const LightClusterGrid& clusters) {
+    // Bound once for the frame: every program reads the same ClusterLightData block and buffers
+    uniformRing.bind(CLUSTER_LIGHTS_BINDING, &clusters.getBlock(), sizeof(ClusterLightingBlock));
+
+    const auto& records = clusters.getClusters();
+    const auto& indices = clusters.getLightIndices();
+    uploadTextureBuffer(clusterGrid, GL_RG32UI, records.data(),
+                        records.size() * sizeof(ClusterRecord));
+    uploadTextureBuffer(clusterLightIndices, GL_R16UI, indices.empty() ? nullptr : indices.data(),
+                        indices.size() * sizeof(uint16_t));
+
+    state.bindTexture(OpenGLShaderProgram::CLUSTER_GRID_UNIT, GL_TEXTURE_BUFFER,
+                      clusterGrid.texture);
+    state.bindTexture(OpenGLShaderProgram::CLUSTER_LIGHT_INDEX_UNIT, GL_TEXTURE_BUFFER,
+                      clusterLightIndices.texture);
+}
+
+void OpenGLRendererBackend::renderWorldObjects(const RenderQueue& queue,
+                                               const std::vector<Light*>& lights) {
+    buildBatches(queue);
+    uploadInstanceData();
+    spriteBatcher.upload();
+
+    const ShaderProgram* currentProgram = nullptr;
+    const Material* currentMaterial = nullptr;
+
+    for (const auto& batch : batches) {
+        const auto& item = queue[batch.first];
+
+        auto program = item.material->getShaderProgram();
+        if (!program || !program->isValid())
+            continue;
+
+        // The queue is sorted by program first, so programs change rarely.
+        // Clustered lights come from the ClusterLightData block and buffers bound for the
+        // frame; LightData keeps feeding shaders written against the single-light block
+        if (program != currentProgram) {
+            applyMaterial(item.material);
+            if (item.mesh && !lights.empty())
+                item.material->applyLight(*lights[0]);
+            currentProgram = program;
+            currentMaterial = nullptr;
+        }
+        if (item.material != currentMaterial) {
+            item.material->applyParameters();
+            currentMaterial = item.material;
+        }
+
+        switch (batch.kind) {
+        case BatchKind::INSTANCED:
+            drawInstanced(*item.mesh, batch.firstElement, batch.count);
+            break;
+        case BatchKind::SPRITES:
+            // Quads are already in world space
+            matrices.model = glm::mat4(1.0f);
+            uniformRing.bind(MATRICES_BINDING, &matrices, sizeof(matrices));
+            state.bindTexture(0, GL_TEXTURE_2D, item.sprite->getTexture());
+            spriteBatcher.draw(batch.firstElement, batch.count);
+            break;
+        case BatchKind::SINGLE:
+            matrices.model = item.object->getTransform().getModelMatrix();
+            uniformRing.bind(MATRICES_BINDING, &matrices, sizeof(matrices));
+            draw(*item.mesh);
+            break;
+        }
     }
+
+    // Loaders bind element buffers through raw GL, which must not land in a mesh VAO
+    state.bindVertexArray(0);
 }
 
-unsigned int OpenGLRendererBackend::createCubemapTexture(const std::vector<std::string>& faces) {
+unsigned int
+OpenGLRendererBackend::createCubemapTexture(const std::array<TextureImage, 6>& faces) {
     unsigned int textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    state.bindTexture(0, GL_TEXTURE_CUBE_MAP, textureID);
 
-    int width, height, nrChannels;
     for (unsigned int i = 0; i < faces.size(); i++) {
-        unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-
-        if (data) {
-            GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format,
-                         GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        } else {
-            LOG_WARN("Cubemap texture failed to load at path: " + faces[i].c_str());
-            stbi_image_free(data);
+        if (!uploadTextureLevels(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, faces[i])) {
+            LOG_WARN("Cubemap face #" + std::to_string(i) + " failed to upload");
+            glDeleteTextures(1, &textureID);
+            state.onTextureDeleted(textureID);
             return 0;
         }
     }
 
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    // The compiler bakes every face with the same mip chain
+    GLint maxLevel = static_cast<GLint>(faces[0].levelCount) - 1;
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, maxLevel);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER,
+                    maxLevel > 0 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -272,6 +448,7 @@ unsigned int OpenGLRendererBackend::createCubemapTexture(const std::vector<std::
 
 void OpenGLRendererBackend::deleteCubemapTexture(unsigned int textureID) {
     glDeleteTextures(1, &textureID);
+    state.onTextureDeleted(textureID);
 }
 
 void OpenGLRendererBackend::renderSkybox(const Mesh& mesh, unsigned int shaderProgram,
@@ -283,7 +460,7 @@ void OpenGLRendererBackend::renderSkybox(const Mesh& mesh, unsigned int shaderPr
     if (!cameraObj)
         return;
 
-    glDepthFunc(GL_LEQUAL);
+    state.setDepthFunc(GL_LEQUAL);
 
     const auto camPos = cameraObj->getTransform().getPosition(); // Mudar auto& para const auto
     glm::mat4 camView = glm::lookAt({camPos.x, camPos.y, camPos.z}, glm::vec3(0.0f, 0.0f, 0.0f),
@@ -300,106 +477,109 @@ void OpenGLRendererBackend::renderSkybox(const Mesh& mesh, unsigned int shaderPr
                        glm::value_ptr(projection));
     glUniform1i(glGetUniformLocation(shaderProgram, "skybox"), 0);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    state.bindTexture(0, GL_TEXTURE_CUBE_MAP, textureID);
 
     auto vao = static_cast<GLuint>(reinterpret_cast<uintptr_t>(mesh.getMeshBufferHandle()));
-    glBindVertexArray(vao);
+    state.bindVertexArray(vao);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
+    state.bindVertexArray(0);
 
-    glDepthFunc(GL_LESS);
+    state.setDepthFunc(GL_LESS);
 }
 
-void OpenGLRendererBackend::present(SDL_Window* window) { SDL_GL_SwapWindow(window); }
+void OpenGLRendererBackend::present(SDL_Window* window) {
+    uniformRing.endFrame();
+    SDL_GL_SwapWindow(window);
+}
 
 void OpenGLRendererBackend::initSpriteQuad() {
-    float vertices[] = {-0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 0.5f,  -0.5f, 0.0f, 1.0f, 0.0f,
-                        0.5f,  0.5f,  0.0f, 1.0f, 1.0f, -0.5f, -0.5f, 0.0f, 0.0f, 0.0f,
-                        0.5f,  0.5f,  0.0f, 1.0f, 1.0f, -0.5f, 0.5f,  0.0f, 0.0f, 1.0f};
+    // Unit quad, interleaved P3T2, drawn through the regular mesh path
+    static const float vertices[] = {-0.5f, -0.5f, 0.0f, 0.0f, 0.0f, //
+                                     0.5f,  -0.5f, 0.0f, 1.0f, 0.0f, //
+                                     0.5f,  0.5f,  0.0f, 1.0f, 1.0f, //
+                                     -0.5f, 0.5f,  0.0f, 0.0f, 1.0f};
+    static const uint16_t indices[] = {0, 1, 2, 0, 2, 3};
+
+    MeshBufferDesc desc;
+    desc.vertices = vertices;
+    desc.vertexCount = 4;
+    desc.layout = VertexLayout::positionTexcoord();
+    desc.indices = indices;
+    desc.indexCount = 6;
+    desc.indexType = IndexType::UINT16;
+
+    spriteQuad = std::make_unique<Mesh>();
+    spriteQuad->setMeshBuffer(createMeshBuffer());
+    if (!spriteQuad->configure(desc)) {
+        LOG_ERROR("Failed to create sprite quad");
+        spriteQuad.reset();
+    }
+}
 
-    glGenVertexArrays(1, &spriteVAO);
-    glGenBuffers(1, &spriteVBO);
+bool OpenGLRendererBackend::uploadTextureLevels(GLenum target, const TextureImage& image) {
+    if (image.levelCount == 0)
+        return false;
 
-    glBindVertexArray(spriteVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, spriteVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    GLenum compressedFormat = 0;
+    if (image.format == TextureFormat::BC1)
+        compressedFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    else if (image.format == TextureFormat::BC3)
+        compressedFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    if (compressedFormat != 0 && !GLEW_EXT_texture_compression_s3tc) {
+        LOG_ERROR("S3TC textures are not supported by this driver");
+        return false;
+    }
 
-    glBindVertexArray(0);
+    for (uint32_t level = 0; level < image.levelCount; level++) {
+        const auto& data = image.levels[level];
+        if (compressedFormat != 0) {
+            glCompressedTexImage2D(target, level, compressedFormat, data.width, data.height, 0,
+                                   data.size, data.data);
+        } else {
+            glTexImage2D(target, level, GL_RGBA8, data.width, data.height, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, data.data);
+        }
+    }
+    return true;
 }
 
-unsigned int OpenGLRendererBackend::loadTexture(const std::string& path, uint8_t filterType) {
+unsigned int OpenGLRendererBackend::loadTexture(const TextureImage& image, uint8_t filterType) {
     unsigned int textureID;
     glGenTextures(1, &textureID);
+    state.bindTexture(0, GL_TEXTURE_2D, textureID);
 
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-
-    if (data) {
-        LOG_INFO("Texture loaded: " + path + " (" + std::to_string(width) + "x" +
-                 std::to_string(height) + ", " + std::to_string(nrChannels) + " channels)");
+    if (!uploadTextureLevels(GL_TEXTURE_2D, image)) {
+        LOG_ERROR("Failed to upload texture");
+        glDeleteTextures(1, &textureID);
+        state.onTextureDeleted(textureID);
+        return 0;
+    }
 
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    LOG_INFO("Texture loaded: " + std::to_string(image.getWidth()) + "x" +
+             std::to_string(image.getHeight()) + ", " + std::to_string(image.levelCount) +
+             " levels, format " + std::to_string(static_cast<int>(image.format)));
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.levelCount - 1);
 
-        GLenum filter = (filterType == 1) ? GL_LINEAR : GL_NEAREST;
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
-
-        stbi_image_free(data);
-    } else {
-        LOG_ERROR("Failed to load texture: " + path);
-    }
+    GLenum filter = (filterType == 1) ? GL_LINEAR : GL_NEAREST;
+    GLenum minFilter = filter;
+    if (image.levelCount > 1)
+        minFilter = (filterType == 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
 
     return textureID;
 }
 
 void OpenGLRendererBackend::drawSprite(const Sprite& sprite) {
-    LOG_INFO("Drawing sprite - TextureID: " + std::to_string(sprite.getTexture()) + " Width: " +
-             std::to_string(sprite.getWidth()) + " Height: " + std::to_string(sprite.getHeight()));
-
-    // Não sobrescrever a matriz model, apenas aplicar a escala do sprite
-    // A matriz model já foi configurada em renderGameObjects com o Transform
-    glm::mat4 spriteScale =
-        glm::scale(glm::mat4(1.0f), glm::vec3(sprite.getWidth(), sprite.getHeight(), 1.0f));
-
-    glm::mat4 currentModel;
-    glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
-    glGetBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(currentModel));
-
-    // Multiplicar: transform * escala do sprite
-    glm::mat4 finalModel = currentModel * spriteScale;
-
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(finalModel));
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, sprite.getTexture());
-
-    GLint currentProgram;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
-    GLint texLoc =
-        glGetUniformLocation(currentProgram, "SPIRV_Cross_CombinedspriteTexturespriteSampler");
-    LOG_INFO("Texture uniform location: " + std::to_string(texLoc));
-    if (texLoc != -1) {
-        glUniform1i(texLoc, 0);
-    }
+    // Draws one unit quad with whatever model matrix is bound; renderWorldObjects batches
+    // sprites through spriteBatcher instead
+    state.bindTexture(0, GL_TEXTURE_2D, sprite.getTexture());
 
-    glBindVertexArray(spriteVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
-
-    GLenum err = glGetError();
-    if (err != GL_NO_ERROR) {
-        LOG_ERROR("OpenGL error in drawSprite: " + std::to_string(err));
-    }
+    // The sprite sampler was pointed at unit 0 when the program was linked
+    if (spriteQuad)
+        draw(*spriteQuad);
 }
@@ -1,30 +1,94 @@
 #ifndef OPEN_GL_RENDERER_BACKEND_HPP
 #define OPEN_GL_RENDERER_BACKEND_HPP
 
+#include "../../../color.hpp"
 #include "../../../graphics_api.hpp"
 #include "../../../mesh.hpp"
 #include "../../../world_object.hpp"
 #include "../../renderer_backend.hpp"
+#include "open_gl_program_cache.hpp"
+#include "open_gl_sprite_batcher.hpp"
+#include "open_gl_state_cache.hpp"
+#include "open_gl_uniform_ring.hpp"
 #include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 class OpenGLRendererBackend : public RendererBackend {
   private:
-    GLuint spriteVAO = 0;
-    GLuint spriteVBO = 0;
-    GLuint matricesUBO = 0;
-    GLuint materialDataUBO = 0;
-    GLuint lightDataUBO = 0;
-    std::unordered_map<std::string, GLuint> uniformBindings;
+    std::unique_ptr<Mesh> spriteQuad;
+    // Declared before the ring, which still binds through it while being destroyed
+    OpenGLStateCache state;
+    // All uniform blocks are streamed through the ring, bound at their UniformBlock index
+    OpenGLUniformRing uniformRing;
+    // Loaded at init, written back at shutdown
+    OpenGLProgramCache programCache;
+    bool parallelShaderCompile = false;
+    // Layout of the ModelViewProjection block
+    struct MatricesBlock {
+        glm::mat4 model;
+        glm::mat4 view;
+        glm::mat4 projection;
+    };
+    MatricesBlock matrices{glm::mat4(1.0f), glm::mat4(1.0f), glm::mat4(1.0f)};
+
+    // Matches the per-instance inputs of OpenGLShaderProgram
+    struct InstanceData {
+        glm::mat4 model;
+        ColorRGBA color;
+    };
+    enum class BatchKind : uint8_t { SINGLE, INSTANCED, SPRITES };
+    // A run of queue items drawn with one call. firstElement is the first instance in
+    // instanceVBO for INSTANCED runs and the first quad in spriteBatcher for SPRITES runs
+    struct DrawBatch {
+        size_t first;
+        size_t count;
+        size_t firstElement;
+        BatchKind kind;
+    };
+    GLuint instanceVBO = 0;
+    size_t instanceVBOCapacity = 0;
+    std::vector<InstanceData> instanceData;
+    std::vector<DrawBatch> batches;
+    OpenGLSpriteBatcher spriteBatcher;
+
+    // Buffer texture streamed once per frame, read with texelFetch
+    struct TextureBuffer {
+        GLuint buffer = 0;
+        GLuint texture = 0;
+        size_t capacity = 0;
+    };
+    // (offset, count) per cluster and the light indices they point into
+    TextureBuffer clusterGrid;
+    TextureBuffer clusterLightIndices;
 
     void initSpriteQuad();
+    void buildBatches(const RenderQueue& queue);
+    static bool canBatchSprites(const RenderItem& first, const RenderItem& item);
+    void uploadInstanceData();
+    void drawInstanced(const Mesh& mesh, size_t firstInstance, size_t instanceCount);
+    bool uploadTextureLevels(GLenum target, const TextureImage& image);
+    void uploadTextureBuffer(TextureBuffer& target, GLenum format, const void* data,
+                             size_t size);
+    void deleteTextureBuffer(TextureBuffer& target);
 
   public:
     ~OpenGLRendererBackend();
 
-    unsigned int loadTexture(const std::string& path, uint8_t filterType = 0) override;
+    void beginFrame() override;
+
+    OpenGLStateCache& getStateCache() { return state; }
+    OpenGLUniformRing& getUniformRing() { return uniformRing; }
+    OpenGLProgramCache& getProgramCache() { return programCache; }
+    // True when the driver compiles and links in the background (KHR_parallel_shader_compile)
+    bool hasParallelShaderCompile() const { return parallelShaderCompile; }
+    // Issued versus filtered state changes of the last complete frame
+    const OpenGLStateCache::Counters& getStateCounters() const {
+        return state.getLastFrameCounters();
+    }
+    unsigned int loadTexture(const TextureImage& image, uint8_t filterType = 0) override;
     void drawSprite(const Sprite& sprite) override;
     bool init() override;
     void present(SDL_Window* window) override;
@@ -35,7 +99,7 @@ class OpenGLRendererBackend : public RendererBackend {
     void clear(Camera* camera) override;
     void draw(const Mesh&) override;
     void setUniforms(ShaderProgram* shaderProgram) override;
-    unsigned int createCubemapTexture(const std::vector<std::string>& faces) override;
+    unsigned int createCubemapTexture(const std::array<TextureImage, 6>& faces) override;
     std::unique_ptr<ShaderProgram> createShaderProgram() override;
     std::unique_ptr<ShaderCompiler> createShaderCompiler() override;
     std::unique_ptr<MeshBuffer> createMeshBuffer() override;
@@ -43,8 +107,9 @@ class OpenGLRendererBackend : public RendererBackend {
     GraphicsAPI getGraphicsAPI() const override;
     std::string getShaderExtension() const override;
 
-    void renderWorldObjects(const std::vector<WorldObject*>& objects,
-                            const std::vector<Light*>& lights) override;
+    bool supportsLightClusters() const override;
+    void uploadLightClusters(const LightClusterGrid& clusters) override;
+    void renderWorldObjects(const RenderQueue& queue, const std::vector<Light*>& lights) override;
 
     void deleteCubemapTexture(unsigned int textureID);
     void renderSkybox(const Mesh& mesh, unsigned int shaderProgram,
@@ -25,17 +25,9 @@ bool OpenGLShaderCompiler::compile(const std::string& source, ShaderType type, v
     
     const char* sourcePtr = shaderSource.c_str();
     glShaderSource(shader, 1, &sourcePtr, nullptr);
-    glCompileShader(shader);
-    
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        GLchar infoLog[512];
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        LOG_ERROR("Shader compilation error: " + infoLog);
-        glDeleteShader(shader);
-        return false;
-    } 
+    // glCompileShader is left to OpenGLShaderProgram::link, which skips it entirely when
+    // the program binary cache already holds the linked program and otherwise compiles
+    // without waiting for the result
     
     *outHandle = reinterpret_cast<void*>(shader);
     return true;
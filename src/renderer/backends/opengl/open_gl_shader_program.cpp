@@ -1,16 +1,32 @@
 #define CLASS_NAME "OpenGLShaderProgram"
 #include "open_gl_shader_program.hpp"
+#include "open_gl_renderer_backend.hpp"
 #include "log_macros.hpp"
 #include "shader_asset.hpp"
 #include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
 
+OpenGLShaderProgram::OpenGLShaderProgram(OpenGLRendererBackend* backend) {
+    if (backend) {
+        uniformRing = &backend->getUniformRing();
+        state = &backend->getStateCache();
+        programCache = &backend->getProgramCache();
+        parallelCompile = backend->hasParallelShaderCompile();
+    }
+}
 
 OpenGLShaderProgram::~OpenGLShaderProgram() {
-    for (auto& pair : uniformBuffers) {
-        glDeleteBuffers(1, &pair.second);
+    for (GLuint buffer : uniformBuffers) {
+        if (buffer != 0)
+            glDeleteBuffers(1, &buffer);
     }
     if (programID != 0) {
         glDeleteProgram(programID);
+        if (state)
+            state->onProgramDeleted(programID);
     }
 }
 
@@ -25,56 +41,189 @@ bool OpenGLShaderProgram::attachShader(const ShaderAsset& shader) {
     return true;
 }
 
+std::vector<GLuint> OpenGLShaderProgram::getAttachedShaders() const {
+    GLint shaderCount = 0;
+    glGetProgramiv(programID, GL_ATTACHED_SHADERS, &shaderCount);
+    std::vector<GLuint> shaders(static_cast<size_t>(shaderCount));
+    glGetAttachedShaders(programID, shaderCount, nullptr, shaders.data());
+    return shaders;
+}
+
+uint64_t OpenGLShaderProgram::hashAttachedSources() const {
+    std::vector<std::pair<GLenum, std::string>> sources;
+    for (GLuint shader : getAttachedShaders()) {
+        GLint type = 0;
+        GLint length = 0;
+        glGetShaderiv(shader, GL_SHADER_TYPE, &type);
+        glGetShaderiv(shader, GL_SHADER_SOURCE_LENGTH, &length);
+        std::string source(static_cast<size_t>(length), '\0');
+        if (length > 0)
+            glGetShaderSource(shader, length, nullptr, source.data());
+        sources.emplace_back(static_cast<GLenum>(type), std::move(source));
+    }
+    return programCache->makeKey(sources);
+}
+
 bool OpenGLShaderProgram::link() {
+    bool cached = programCache && programCache->isEnabled();
+    if (cached) {
+        cacheKey = hashAttachedSources();
+        if (programCache->restore(programID, cacheKey)) {
+            linkState = LinkState::READY;
+            reflectUniformBlocks();
+            reflectSamplers();
+            reflectInstanceInputs();
+            return true;
+        }
+    }
+
+    // No status queries here: each one would make the driver finish this program before
+    // the loader can submit the next. isReady() collects the result later
+    for (GLuint shader : getAttachedShaders())
+        glCompileShader(shader);
+    if (cached)
+        glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(programID);
+    linkState = LinkState::PENDING;
+    return true;
+}
+
+bool OpenGLShaderProgram::isReady() {
+    if (linkState == LinkState::PENDING) {
+        GLint complete = GL_TRUE;
+        if (parallelCompile)
+            glGetProgramiv(programID, GL_COMPLETION_STATUS_KHR, &complete);
+        if (complete != GL_TRUE)
+            return false;
+        finishLink();
+    }
+    return linkState == LinkState::READY;
+}
 
+void OpenGLShaderProgram::finishLink() {
     GLint success;
     glGetProgramiv(programID, GL_LINK_STATUS, &success);
     if (success != GL_TRUE) {
         GLchar infoLog[512];
+        for (GLuint shader : getAttachedShaders()) {
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+            if (success != GL_TRUE) {
+                glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+                LOG_ERROR("Shader compilation error: " + infoLog);
+            }
+        }
         glGetProgramInfoLog(programID, 512, nullptr, infoLog);
         LOG_ERROR("Shader program link error: " + infoLog);
-        return false;
+        linkState = LinkState::FAILED;
+        return;
     }
 
-    uniformBindings["ModelViewProjection"] = 0;
-    uniformBindings["MaterialData"] = 1;
-    uniformBindings["LightData"] = 2;
+    if (programCache && programCache->isEnabled())
+        programCache->store(programID, cacheKey);
+    linkState = LinkState::READY;
+    reflectUniformBlocks();
+    reflectSamplers();
+    reflectInstanceInputs();
+}
 
-    return true;
+void OpenGLShaderProgram::reflectUniformBlocks() {
+    for (bool& present : uniformBlocks)
+        present = false;
+
+    GLint blockCount = 0;
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    for (GLint i = 0; i < blockCount; i++) {
+        GLchar name[128];
+        glGetActiveUniformBlockName(programID, i, sizeof(name), nullptr, name);
+
+        //Spirv-cross prefixes uniforms with 'type_'
+        const char* blockName = name;
+        if (std::strncmp(blockName, "type_", 5) == 0)
+            blockName += 5;
+
+        UniformBlock block;
+        if (!findUniformBlock(blockName, block)) {
+            LOG_WARN("Uniform block " + std::string(name) + " is not fed by the engine");
+            continue;
+        }
+        // Block bindings are program state, so they are set once here instead of per update
+        glUniformBlockBinding(programID, i, static_cast<GLuint>(block));
+        uniformBlocks[static_cast<uint32_t>(block)] = true;
+    }
 }
 
-void OpenGLShaderProgram::use() { glUseProgram(programID); }
+void OpenGLShaderProgram::reflectSamplers() {
+    samplerCount = 0;
 
-void OpenGLShaderProgram::setUniformBuffer(const char* name, const void* data, size_t size) {
-    auto it = uniformBindings.find(name);
-    if (it == uniformBindings.end()) {
-        LOG_WARN("Uniform binding for " + std::string(name) + " not found!");
-        return;
+    GLint uniformCount = 0;
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &uniformCount);
+    use();
+    for (GLint i = 0; i < uniformCount; i++) {
+        GLchar name[128];
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(programID, i, sizeof(name), nullptr, &size, &type, name);
+        if (type == GL_UNSIGNED_INT_SAMPLER_BUFFER) {
+            GLint location = glGetUniformLocation(programID, name);
+            if (location != -1 && std::strcmp(name, "clusterGrid") == 0)
+                glUniform1i(location, static_cast<GLint>(CLUSTER_GRID_UNIT));
+            else if (location != -1 && std::strcmp(name, "clusterLightIndices") == 0)
+                glUniform1i(location, static_cast<GLint>(CLUSTER_LIGHT_INDEX_UNIT));
+            continue;
+        }
+        if (type != GL_SAMPLER_2D && type != GL_SAMPLER_CUBE)
+            continue;
+
+        // Sampler units never change afterwards, so draws only bind textures
+        GLint location = glGetUniformLocation(programID, name);
+        if (location != -1)
+            glUniform1i(location, static_cast<GLint>(samplerCount++));
     }
+}
 
-    //Spirv-cross prefixes uniforms with 'type_'
-    GLuint blockIndex = glGetUniformBlockIndex(programID, ("type_" + std::string(name)).c_str());
-    if (blockIndex == GL_INVALID_INDEX) {
-        LOG_WARN("Uniform block index for " + std::string(name) + " not found!");
-        return;
+void OpenGLShaderProgram::reflectInstanceInputs() {
+    instanced = false;
+
+    GLint attributeCount = 0;
+    glGetProgramiv(programID, GL_ACTIVE_ATTRIBUTES, &attributeCount);
+    for (GLint i = 0; i < attributeCount; i++) {
+        GLchar name[128];
+        GLint size;
+        GLenum type;
+        glGetActiveAttrib(programID, i, sizeof(name), nullptr, &size, &type, name);
+        if (type == GL_FLOAT_MAT4 &&
+            glGetAttribLocation(programID, name) == static_cast<GLint>(INSTANCE_MODEL_LOCATION)) {
+            instanced = true;
+            break;
+        }
     }
+}
+
+void OpenGLShaderProgram::use() {
+    if (state)
+        state->useProgram(programID);
+    else
+        glUseProgram(programID);
+}
+
+void OpenGLShaderProgram::setUniformBuffer(UniformBlock block, const void* data, size_t size) {
+    auto index = static_cast<uint32_t>(block);
+    if (!uniformBlocks[index])
+        return;
 
-    int binding = it->second;
-    glUniformBlockBinding(programID, blockIndex, binding);
+    if (uniformRing) {
+        uniformRing->bind(index, data, size);
+        return;
+    }
 
-    // Se name não existe no mapa, cria uma entrada com valor 0
-    // Se já existe, retorna referência ao GLuint existente
-    GLuint& ubo = uniformBuffers[name];
+    GLuint& ubo = uniformBuffers[index];
     if (ubo == 0) {
         //Só cria o buffer OpenGL na primeira vez que é usado
-        //O ID gerado é armazenado no mapa para reutilização
         glGenBuffers(1, &ubo);
     }
     
     glBindBuffer(GL_UNIFORM_BUFFER, ubo);
     glBufferData(GL_UNIFORM_BUFFER, size, data, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_UNIFORM_BUFFER, binding, ubo);
+    glBindBufferBase(GL_UNIFORM_BUFFER, index, ubo);
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
-
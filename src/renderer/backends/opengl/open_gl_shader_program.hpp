@@ -1,25 +1,72 @@
 #ifndef OPEN_GL_SHADER_PROGRAM_HPP
 #define OPEN_GL_SHADER_PROGRAM_HPP
 
+#include "open_gl_program_cache.hpp"
+#include "open_gl_state_cache.hpp"
+#include "open_gl_uniform_ring.hpp"
 #include "shader_program.hpp"
 #include <GL/glew.h>
-#include <unordered_map>
-#include <string>
+#include <cstdint>
+#include <vector>
+
+class OpenGLRendererBackend;
 
 class OpenGLShaderProgram : public ShaderProgram {
 private:
     GLuint programID = 0;
-    std::unordered_map<std::string, int> uniformBindings;
-    std::unordered_map<std::string, GLuint> uniformBuffers;
+    // Shared with the backend; without one, each block gets its own buffer and binds go
+    // straight to GL
+    OpenGLUniformRing* uniformRing = nullptr;
+    OpenGLStateCache* state = nullptr;
+    OpenGLProgramCache* programCache = nullptr;
+    // With KHR_parallel_shader_compile, isReady() polls GL_COMPLETION_STATUS_KHR; without
+    // it, the first poll waits for the driver
+    bool parallelCompile = false;
+    enum class LinkState : uint8_t { UNLINKED, PENDING, READY, FAILED };
+    LinkState linkState = LinkState::UNLINKED;
+    uint64_t cacheKey = 0;
+    // Reflected at link time, indexed by UniformBlock; blocks the program does not
+    // declare are skipped without touching GL
+    bool uniformBlocks[UNIFORM_BLOCK_COUNT] = {};
+    GLuint uniformBuffers[UNIFORM_BLOCK_COUNT] = {};
+    uint32_t samplerCount = 0;
+    bool instanced = false;
+
+    std::vector<GLuint> getAttachedShaders() const;
+    uint64_t hashAttachedSources() const;
+    // Reads the link result, logging compile and link errors, then reflects the program
+    void finishLink();
+    void reflectUniformBlocks();
+    void reflectSamplers();
+    void reflectInstanceInputs();
 
 public:
+    // Per-instance vertex inputs of instanced programs, fed by OpenGLRendererBackend
+    static constexpr GLuint INSTANCE_MODEL_LOCATION = 4; // mat4, occupies locations 4-7
+    static constexpr GLuint INSTANCE_COLOR_LOCATION = 8; // vec4 base color
+    // Fixed units of the clustered lighting buffers (usamplerBuffer clusterGrid and
+    // clusterLightIndices), bound once per frame by OpenGLRendererBackend
+    static constexpr GLuint CLUSTER_GRID_UNIT = 14;
+    static constexpr GLuint CLUSTER_LIGHT_INDEX_UNIT = 15;
+
+    explicit OpenGLShaderProgram(OpenGLRendererBackend* backend = nullptr);
     ~OpenGLShaderProgram() override;
     bool attachShader(const ShaderAsset& shader) override;
     bool link() override;
     void use() override;
-    void setUniformBuffer(const char* name, const void* data, size_t size) override;
+    void setUniformBuffer(UniformBlock block, const void* data, size_t size) override;
     void* getHandle() const override { return reinterpret_cast<void*>(programID); }
     bool isValid() const override { return programID != 0; }
+    bool isReady() override;
+    bool hasUniformBlock(UniformBlock block) const {
+        return uniformBlocks[static_cast<uint32_t>(block)];
+    }
+    // Samplers are assigned texture units 0..count-1 in declaration order at link time,
+    // apart from the clustered lighting buffers
+    uint32_t getSamplerCount() const { return samplerCount; }
+    // True when the vertex shader reads its model matrix from INSTANCE_MODEL_LOCATION
+    // instead of the ModelViewProjection block
+    bool usesInstancing() const { return instanced; }
 };
 
 #endif // OPENGLSHADERPROGRAM_HPP
@@ -0,0 +1,124 @@
+#define CLASS_NAME "OpenGLSpriteBatcher"
+#include "log_macros.hpp"
+
+#include "../../../vertex_layout.hpp"
+#include "open_gl_sprite_batcher.hpp"
+#include <cstddef>
+
+OpenGLSpriteBatcher::~OpenGLSpriteBatcher() { destroy(); }
+
+bool OpenGLSpriteBatcher::init(OpenGLStateCache& state) {
+    destroy();
+    this->state = &state;
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vertexBuffer);
+    glGenBuffers(1, &indexBuffer);
+    if (!vao || !vertexBuffer || !indexBuffer) {
+        LOG_ERROR("Failed to create sprite batch buffers");
+        destroy();
+        return false;
+    }
+
+    state.bindVertexArray(vao);
+    state.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    const VertexLayout layout = VertexLayout::positionTexcoord();
+    for (uint32_t i = 0; i < layout.attributeCount; i++) {
+        const auto& attribute = layout.attributes[i];
+        glVertexAttribPointer(attribute.location, getVertexFormatComponents(attribute.format),
+                              GL_FLOAT, GL_FALSE, sizeof(SpriteVertex),
+                              reinterpret_cast<void*>(static_cast<uintptr_t>(attribute.offset)));
+        glEnableVertexAttribArray(attribute.location);
+    }
+    // The element buffer binding is recorded in the VAO
+    state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    state.bindVertexArray(0);
+    return true;
+}
+
+void OpenGLSpriteBatcher::destroy() {
+    if (vao) {
+        glDeleteVertexArrays(1, &vao);
+        state->onVertexArrayDeleted(vao);
+        vao = 0;
+    }
+    for (GLuint* buffer : {&vertexBuffer, &indexBuffer}) {
+        if (*buffer) {
+            glDeleteBuffers(1, buffer);
+            state->onBufferDeleted(*buffer);
+            *buffer = 0;
+        }
+    }
+    vertexCapacity = 0;
+    indexCapacity = 0;
+}
+
+uint32_t OpenGLSpriteBatcher::add(const glm::mat4& model, const Sprite& sprite) {
+    // Corner = origin + x * axisX + y * axisY, with x and y in {-0.5, 0.5}
+    const glm::vec3 axisX = glm::vec3(model[0]) * sprite.getWidth();
+    const glm::vec3 axisY = glm::vec3(model[1]) * sprite.getHeight();
+    const glm::vec3 origin = glm::vec3(model[3]);
+
+    const glm::vec3 bottomLeft = origin - 0.5f * axisX - 0.5f * axisY;
+    const glm::vec3 corners[4] = {bottomLeft, bottomLeft + axisX, bottomLeft + axisX + axisY,
+                                  bottomLeft + axisY};
+    const float* uv = sprite.getUVRect();
+    const float texcoords[4][2] = {{uv[0], uv[1]}, {uv[2], uv[1]}, {uv[2], uv[3]}, {uv[0], uv[3]}};
+
+    uint32_t quad = static_cast<uint32_t>(getQuadCount());
+    for (int i = 0; i < 4; i++) {
+        vertices.push_back(SpriteVertex{{corners[i].x, corners[i].y, corners[i].z},
+                                        {texcoords[i][0], texcoords[i][1]}});
+    }
+    return quad;
+}
+
+void OpenGLSpriteBatcher::growIndices(size_t quadCount) {
+    size_t capacity = indexCapacity ? indexCapacity : 256;
+    while (capacity < quadCount)
+        capacity *= 2;
+
+    std::vector<uint32_t> indices(capacity * 6);
+    for (size_t quad = 0; quad < capacity; quad++) {
+        uint32_t base = static_cast<uint32_t>(quad * 4);
+        uint32_t* index = &indices[quad * 6];
+        index[0] = base;
+        index[1] = base + 1;
+        index[2] = base + 2;
+        index[3] = base;
+        index[4] = base + 2;
+        index[5] = base + 3;
+    }
+
+    state->bindVertexArray(vao);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(),
+                 GL_STATIC_DRAW);
+    indexCapacity = capacity;
+}
+
+void OpenGLSpriteBatcher::upload() {
+    size_t quadCount = getQuadCount();
+    if (quadCount == 0 || !vao)
+        return;
+
+    if (quadCount > indexCapacity)
+        growIndices(quadCount);
+
+    if (quadCount > vertexCapacity)
+        vertexCapacity = quadCount + quadCount / 2;
+
+    // Orphan last frame's storage instead of waiting for the GPU to finish reading it
+    state->bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertexCapacity * 4 * sizeof(SpriteVertex), nullptr,
+                 GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(SpriteVertex), vertices.data());
+}
+
+void OpenGLSpriteBatcher::draw(size_t firstQuad, size_t quadCount) {
+    if (!vao || quadCount == 0)
+        return;
+
+    state->bindVertexArray(vao);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(quadCount * 6), GL_UNSIGNED_INT,
+                   reinterpret_cast<void*>(firstQuad * 6 * sizeof(uint32_t)));
+}
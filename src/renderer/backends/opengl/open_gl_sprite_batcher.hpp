@@ -0,0 +1,52 @@
+#ifndef OPEN_GL_SPRITE_BATCHER_HPP
+#define OPEN_GL_SPRITE_BATCHER_HPP
+
+#include "../../../sprite.hpp"
+#include "open_gl_state_cache.hpp"
+#include <GL/glew.h>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Collects a frame's sprites as world-space quads in one streaming vertex buffer.
+// Corners are transformed on the CPU, so any run of quads that shares a texture and a
+// material is drawn with a single glDrawElements and an identity model matrix.
+// Vertices use VertexLayout::positionTexcoord(), like the regular sprite quad.
+class OpenGLSpriteBatcher {
+  private:
+    struct SpriteVertex {
+        float position[3];
+        float texcoord[2];
+    };
+
+    OpenGLStateCache* state = nullptr;
+    GLuint vao = 0;
+    GLuint vertexBuffer = 0;
+    GLuint indexBuffer = 0;
+    size_t vertexCapacity = 0; // in quads
+    size_t indexCapacity = 0;  // in quads
+    std::vector<SpriteVertex> vertices;
+
+    void growIndices(size_t quadCount);
+
+  public:
+    OpenGLSpriteBatcher() = default;
+    OpenGLSpriteBatcher(const OpenGLSpriteBatcher&) = delete;
+    OpenGLSpriteBatcher& operator=(const OpenGLSpriteBatcher&) = delete;
+    ~OpenGLSpriteBatcher();
+
+    bool init(OpenGLStateCache& state);
+    void destroy();
+
+    void clear() { vertices.clear(); }
+    // Appends the sprite's unit quad, scaled to its size and transformed by model;
+    // returns the index of the quad
+    uint32_t add(const glm::mat4& model, const Sprite& sprite);
+    size_t getQuadCount() const { return vertices.size() / 4; }
+
+    // Streams every quad added since clear() to the GPU
+    void upload();
+    void draw(size_t firstQuad, size_t quadCount);
+};
+
+#endif
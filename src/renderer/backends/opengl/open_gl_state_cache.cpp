@@ -0,0 +1,171 @@
+#include "open_gl_state_cache.hpp"
+
+void OpenGLStateCache::invalidate() {
+    Counters counters = frameCounters;
+    Counters lastCounters = lastFrameCounters;
+    *this = OpenGLStateCache();
+    frameCounters = counters;
+    lastFrameCounters = lastCounters;
+}
+
+void OpenGLStateCache::beginFrame() {
+    lastFrameCounters = frameCounters;
+    frameCounters = Counters();
+}
+
+void OpenGLStateCache::useProgram(GLuint id) {
+    if (filter(program != id)) {
+        glUseProgram(id);
+        program = id;
+    }
+}
+
+void OpenGLStateCache::bindVertexArray(GLuint id) {
+    if (filter(vertexArray != id)) {
+        glBindVertexArray(id);
+        vertexArray = id;
+    }
+}
+
+void OpenGLStateCache::bindBuffer(GLenum target, GLuint id) {
+    GLuint* shadow = nullptr;
+    if (target == GL_ARRAY_BUFFER)
+        shadow = &arrayBuffer;
+    else if (target == GL_UNIFORM_BUFFER)
+        shadow = &uniformBuffer;
+
+    if (!shadow) {
+        frameCounters.issued++;
+        glBindBuffer(target, id);
+        return;
+    }
+    if (filter(*shadow != id)) {
+        glBindBuffer(target, id);
+        *shadow = id;
+    }
+}
+
+void OpenGLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint id, GLintptr offset,
+                                       GLsizeiptr size) {
+    if (target != GL_UNIFORM_BUFFER || index >= MAX_UNIFORM_BINDINGS) {
+        frameCounters.issued++;
+        glBindBufferRange(target, index, id, offset, size);
+        return;
+    }
+
+    BufferRange& range = uniformRanges[index];
+    if (filter(range.buffer != id || range.offset != offset || range.size != size)) {
+        glBindBufferRange(target, index, id, offset, size);
+        range = BufferRange{id, offset, size};
+        // Indexed binds also replace the generic binding point
+        uniformBuffer = id;
+    }
+}
+
+void OpenGLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint id) {
+    if (target != GL_UNIFORM_BUFFER || index >= MAX_UNIFORM_BINDINGS) {
+        frameCounters.issued++;
+        glBindBufferBase(target, index, id);
+        return;
+    }
+
+    // A size of 0 stands for the whole buffer
+    BufferRange& range = uniformRanges[index];
+    if (filter(range.buffer != id || range.offset != 0 || range.size != 0)) {
+        glBindBufferBase(target, index, id);
+        range = BufferRange{id, 0, 0};
+        uniformBuffer = id;
+    }
+}
+
+void OpenGLStateCache::setActiveUnit(GLuint unit) {
+    if (filter(activeUnit != unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+    }
+}
+
+void OpenGLStateCache::bindTexture(GLuint unit, GLenum target, GLuint id) {
+    if (unit >= MAX_TEXTURE_UNITS) {
+        frameCounters.issued += 2;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, id);
+        activeUnit = unit;
+        return;
+    }
+
+    TextureUnit& shadow = textureUnits[unit];
+    if (shadow.target == target && shadow.texture == id) {
+        frameCounters.filtered++;
+        return;
+    }
+    setActiveUnit(unit);
+    frameCounters.issued++;
+    glBindTexture(target, id);
+    shadow = TextureUnit{target, id};
+}
+
+void OpenGLStateCache::setDepthTest(bool enabled) {
+    if (filter(depthTest != static_cast<int8_t>(enabled))) {
+        if (enabled)
+            glEnable(GL_DEPTH_TEST);
+        else
+            glDisable(GL_DEPTH_TEST);
+        depthTest = enabled;
+    }
+}
+
+void OpenGLStateCache::setDepthFunc(GLenum func) {
+    if (filter(depthFunc != func)) {
+        glDepthFunc(func);
+        depthFunc = func;
+    }
+}
+
+void OpenGLStateCache::setBlend(bool enabled) {
+    if (filter(blend != static_cast<int8_t>(enabled))) {
+        if (enabled)
+            glEnable(GL_BLEND);
+        else
+            glDisable(GL_BLEND);
+        blend = enabled;
+    }
+}
+
+void OpenGLStateCache::setBlendFunc(GLenum src, GLenum dst) {
+    if (filter(blendSrc != src || blendDst != dst)) {
+        glBlendFunc(src, dst);
+        blendSrc = src;
+        blendDst = dst;
+    }
+}
+
+void OpenGLStateCache::onProgramDeleted(GLuint id) {
+    // A deleted program stays current until another one is used; forgetting it keeps a
+    // reused name from being filtered
+    if (program == id)
+        program = UNKNOWN;
+}
+
+void OpenGLStateCache::onVertexArrayDeleted(GLuint id) {
+    if (vertexArray == id)
+        vertexArray = 0;
+}
+
+void OpenGLStateCache::onBufferDeleted(GLuint id) {
+    if (arrayBuffer == id)
+        arrayBuffer = 0;
+    if (uniformBuffer == id)
+        uniformBuffer = 0;
+    for (auto& range : uniformRanges) {
+        if (range.buffer == id)
+            range = BufferRange{0, 0, 0};
+    }
+}
+
+void OpenGLStateCache::onTextureDeleted(GLuint id) {
+    for (auto& unit : textureUnits) {
+        if (unit.texture == id)
+            unit.texture = 0;
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef OPEN_GL_STATE_CACHE_HPP
+#define OPEN_GL_STATE_CACHE_HPP
+
+#include <GL/glew.h>
+#include <cstdint>
+
+// Shadow copy of the GL state the backend touches while drawing. Every setter compares
+// against the shadow and only reaches the driver when the value actually changes.
+//
+// Code that binds through raw GL (mesh buffer creation, texture uploads at load time)
+// leaves the shadows stale, so the backend calls invalidate() at the start of each frame.
+class OpenGLStateCache {
+  public:
+    struct Counters {
+        uint32_t issued = 0;
+        uint32_t filtered = 0;
+    };
+
+    static constexpr uint32_t MAX_TEXTURE_UNITS = 16;
+    static constexpr uint32_t MAX_UNIFORM_BINDINGS = 16;
+
+  private:
+    static constexpr GLuint UNKNOWN = ~0u;
+
+    struct BufferRange {
+        GLuint buffer = UNKNOWN;
+        GLintptr offset = 0;
+        GLsizeiptr size = 0;
+    };
+    struct TextureUnit {
+        GLenum target = 0;
+        GLuint texture = UNKNOWN;
+    };
+
+    GLuint program = UNKNOWN;
+    GLuint vertexArray = UNKNOWN;
+    GLuint arrayBuffer = UNKNOWN;
+    GLuint uniformBuffer = UNKNOWN;
+    BufferRange uniformRanges[MAX_UNIFORM_BINDINGS];
+    GLuint activeUnit = UNKNOWN;
+    TextureUnit textureUnits[MAX_TEXTURE_UNITS];
+    GLenum depthFunc = 0;
+    int8_t depthTest = -1;
+    int8_t blend = -1;
+    GLenum blendSrc = 0;
+    GLenum blendDst = 0;
+
+    Counters frameCounters;
+    Counters lastFrameCounters;
+
+    bool filter(bool changed) {
+        if (changed)
+            frameCounters.issued++;
+        else
+            frameCounters.filtered++;
+        return changed;
+    }
+    void setActiveUnit(GLuint unit);
+
+  public:
+    // Forgets every shadow, so the next call of each kind reaches the driver
+    void invalidate();
+    // Publishes the counters of the frame that just ended and starts new ones
+    void beginFrame();
+    const Counters& getLastFrameCounters() const { return lastFrameCounters; }
+
+    void useProgram(GLuint id);
+    void bindVertexArray(GLuint id);
+    // GL_ARRAY_BUFFER and GL_UNIFORM_BUFFER are tracked; other targets pass through
+    void bindBuffer(GLenum target, GLuint id);
+    void bindBufferRange(GLenum target, GLuint index, GLuint id, GLintptr offset,
+                         GLsizeiptr size);
+    void bindBufferBase(GLenum target, GLuint index, GLuint id);
+    void bindTexture(GLuint unit, GLenum target, GLuint id);
+
+    void setDepthTest(bool enabled);
+    void setDepthFunc(GLenum func);
+    void setBlend(bool enabled);
+    void setBlendFunc(GLenum src, GLenum dst);
+
+    // Deleting a bound object reverts its bindings to 0, and GL may hand the same name
+    // out again, so the shadows must follow
+    void onProgramDeleted(GLuint id);
+    void onVertexArrayDeleted(GLuint id);
+    void onBufferDeleted(GLuint id);
+    void onTextureDeleted(GLuint id);
+};
+
+#endif
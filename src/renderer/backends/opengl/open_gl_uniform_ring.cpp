@@ -0,0 +1,161 @@
+#define CLASS_NAME "OpenGLUniformRing"
+#include "log_macros.hpp"
+
+#include "open_gl_uniform_ring.hpp"
+#include <algorithm>
+#include <cstring>
+
+OpenGLUniformRing::~OpenGLUniformRing() { destroy(); }
+
+bool OpenGLUniformRing::init(size_t bytesPerFrame, OpenGLStateCache& state) {
+    destroy();
+    this->state = &state;
+
+    GLint offsetAlignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+    if (offsetAlignment > 0)
+        alignment = static_cast<size_t>(offsetAlignment);
+
+    return allocate(bytesPerFrame);
+}
+
+bool OpenGLUniformRing::allocate(size_t bytesPerFrame) {
+    frameSize = (bytesPerFrame + alignment - 1) / alignment * alignment;
+    size_t totalSize = frameSize * FRAME_COUNT;
+
+    glGenBuffers(1, &buffer);
+    state->bindBuffer(GL_UNIFORM_BUFFER, buffer);
+    if (GLEW_ARB_buffer_storage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, totalSize, nullptr, flags);
+        mapped = static_cast<uint8_t*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, totalSize, flags));
+        if (!mapped)
+            LOG_WARN("Persistent mapping failed, uniform ring falls back to glBufferSubData");
+    }
+    if (!mapped) {
+        // Immutable storage cannot be respecified, so start over with a mutable buffer
+        glDeleteBuffers(1, &buffer);
+        state->onBufferDeleted(buffer);
+        glGenBuffers(1, &buffer);
+        state->bindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, totalSize, nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    frame = 0;
+    head = 0;
+    end = frameSize;
+    overflowBytes = 0;
+    LOG_INFO("Uniform ring: " + std::to_string(FRAME_COUNT) + " x " + std::to_string(frameSize) +
+             " bytes, " + (mapped ? "persistent" : "sub-data") + ", alignment " +
+             std::to_string(alignment));
+    return true;
+}
+
+void OpenGLUniformRing::destroy() {
+    for (auto& fence : fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (buffer) {
+        if (mapped) {
+            state->bindBuffer(GL_UNIFORM_BUFFER, buffer);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            mapped = nullptr;
+        }
+        glDeleteBuffers(1, &buffer);
+        state->onBufferDeleted(buffer);
+        buffer = 0;
+    }
+    for (GLuint overflowBuffer : overflowBuffers) {
+        if (overflowBuffer) {
+            glDeleteBuffers(1, &overflowBuffer);
+            state->onBufferDeleted(overflowBuffer);
+        }
+    }
+    overflowBuffers.clear();
+}
+
+void OpenGLUniformRing::beginFrame() {
+    if (!buffer)
+        return;
+
+    if (overflowBytes > 0) {
+        // The GL keeps the old storage alive until in-flight draws stop reading it, so the
+        // regions can be replaced right away; fresh regions have no fences to wait on
+        size_t grownSize = std::max(frameSize * 2, frameSize + overflowBytes);
+        LOG_INFO("Uniform ring overflowed by " + std::to_string(overflowBytes) +
+                 " bytes, growing regions to " + std::to_string(grownSize) + " bytes");
+        destroy();
+        allocate(grownSize);
+        return;
+    }
+
+    frame = (frame + 1) % FRAME_COUNT;
+    GLsync& fence = fences[frame];
+    if (fence) {
+        // Normally already signaled: the region was last written FRAME_COUNT - 1 frames ago
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        while (result == GL_TIMEOUT_EXPIRED)
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        if (result == GL_WAIT_FAILED)
+            LOG_ERROR("Waiting on the uniform ring fence failed");
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    head = frame * frameSize;
+    end = head + frameSize;
+}
+
+void OpenGLUniformRing::endFrame() {
+    if (!buffer)
+        return;
+
+    GLsync& fence = fences[frame];
+    if (fence)
+        glDeleteSync(fence);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool OpenGLUniformRing::bind(GLuint binding, const void* data, size_t size) {
+    if (!buffer)
+        return false;
+
+    size_t offset = (head + alignment - 1) / alignment * alignment;
+    if (offset + size > end) {
+        if (overflowBytes == 0)
+            LOG_WARN("Uniform ring region is full (" + std::to_string(frameSize) +
+                     " bytes), streaming the rest of the frame through orphaned buffers");
+        overflowBytes += (size + alignment - 1) / alignment * alignment;
+        bindOverflow(binding, data, size);
+        return true;
+    }
+
+    if (mapped) {
+        std::memcpy(mapped + offset, data, size);
+    } else {
+        state->bindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    }
+    state->bindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+
+    head = offset + size;
+    return true;
+}
+
+void OpenGLUniformRing::bindOverflow(GLuint binding, const void* data, size_t size) {
+    // One buffer per binding point: orphaning a buffer another binding still points at
+    // would swap that binding's data out from under it
+    if (binding >= overflowBuffers.size())
+        overflowBuffers.resize(binding + 1, 0);
+    GLuint& overflowBuffer = overflowBuffers[binding];
+    if (!overflowBuffer)
+        glGenBuffers(1, &overflowBuffer);
+
+    state->bindBuffer(GL_UNIFORM_BUFFER, overflowBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+    state->bindBufferRange(GL_UNIFORM_BUFFER, binding, overflowBuffer, 0, size);
+}
@@ -0,0 +1,63 @@
+#ifndef OPEN_GL_UNIFORM_RING_HPP
+#define OPEN_GL_UNIFORM_RING_HPP
+
+#include "open_gl_state_cache.hpp"
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Streaming uniform buffer split into FRAME_COUNT regions, one per frame in flight.
+// Each draw's uniform data is bump-allocated inside the current frame's region and
+// bound with glBindBufferRange, so the hot loop never reallocates or orphans a buffer.
+// A fence per region keeps the CPU from overwriting data the GPU is still reading.
+//
+// With ARB_buffer_storage the whole buffer is mapped once (persistent + coherent) and
+// writes are plain memcpys; otherwise they fall back to glBufferSubData into the region.
+//
+// A frame that outgrows its region streams the remaining updates through a small orphaned
+// buffer per binding point, and the next beginFrame reallocates the ring with larger regions.
+class OpenGLUniformRing {
+  private:
+    static constexpr uint32_t FRAME_COUNT = 3;
+
+    OpenGLStateCache* state = nullptr;
+    GLuint buffer = 0;
+    uint8_t* mapped = nullptr;
+    size_t frameSize = 0;
+    size_t alignment = 256;
+    uint32_t frame = 0;
+    size_t head = 0;
+    size_t end = 0;
+    GLsync fences[FRAME_COUNT] = {};
+    // Bytes that did not fit in the current region; non-zero triggers a grow in beginFrame
+    size_t overflowBytes = 0;
+    // Indexed by binding point, only created once a region overflows
+    std::vector<GLuint> overflowBuffers;
+
+    bool allocate(size_t bytesPerFrame);
+    void bindOverflow(GLuint binding, const void* data, size_t size);
+
+  public:
+    OpenGLUniformRing() = default;
+    OpenGLUniformRing(const OpenGLUniformRing&) = delete;
+    OpenGLUniformRing& operator=(const OpenGLUniformRing&) = delete;
+    ~OpenGLUniformRing();
+
+    bool init(size_t bytesPerFrame, OpenGLStateCache& state);
+    void destroy();
+
+    // Waits until the GPU is done with the next region and rewinds into it, first growing
+    // the regions if the previous frame overflowed
+    void beginFrame();
+    // Fences the region written since beginFrame
+    void endFrame();
+
+    // Copies size bytes into the current region and binds them to the uniform block
+    // binding point; returns false only when the ring was never initialized
+    bool bind(GLuint binding, const void* data, size_t size);
+
+    bool isPersistent() const { return mapped != nullptr; }
+};
+
+#endif
@@ -0,0 +1,216 @@
+#define CLASS_NAME "VulkanMemoryAllocator"
+#include "log_macros.hpp"
+
+#include "vulkan_memory_allocator.hpp"
+#include <algorithm>
+#include <string>
+
+VulkanMemoryAllocator::~VulkanMemoryAllocator() { destroy(); }
+
+void VulkanMemoryAllocator::init(VkPhysicalDevice physicalDevice, VkDevice device) {
+    destroy();
+    this->device = device;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+}
+
+void VulkanMemoryAllocator::destroy() {
+    for (auto& page : pages) {
+        if (page->mapped)
+            vkUnmapMemory(device, page->memory);
+        vkFreeMemory(device, page->memory, nullptr);
+    }
+    pages.clear();
+}
+
+bool VulkanMemoryAllocator::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags required,
+                                           VkMemoryPropertyFlags preferred,
+                                           uint32_t& memoryType) const {
+    int best = -1;
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[i].propertyFlags;
+        if (!(typeBits & (1u << i)) || (flags & required) != required)
+            continue;
+        if ((flags & preferred) == preferred) {
+            best = static_cast<int>(i);
+            break;
+        }
+        if (best < 0)
+            best = static_cast<int>(i);
+    }
+    if (best < 0)
+        return false;
+    memoryType = static_cast<uint32_t>(best);
+    return true;
+}
+
+VkDeviceSize VulkanMemoryAllocator::getPageSize(uint32_t memoryType) const {
+    // Small heaps (e.g. the 256 MB host-visible device-local window) get smaller pages
+    uint32_t heap = memoryProperties.memoryTypes[memoryType].heapIndex;
+    VkDeviceSize heapSize = memoryProperties.memoryHeaps[heap].size;
+    return std::min(DEFAULT_PAGE_SIZE, std::max<VkDeviceSize>(heapSize / 8, 1024 * 1024));
+}
+
+VulkanMemoryAllocator::Page* VulkanMemoryAllocator::createPage(uint32_t memoryType,
+                                                               VkDeviceSize size,
+                                                               bool dedicated) {
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    auto page = std::make_unique<Page>();
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &page->memory) != VK_SUCCESS) {
+        LOG_ERROR("Failed to allocate a " + std::to_string(size) + " byte page of memory type " +
+                  std::to_string(memoryType));
+        return nullptr;
+    }
+
+    if (memoryProperties.memoryTypes[memoryType].propertyFlags &
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        void* mapped = nullptr;
+        if (vkMapMemory(device, page->memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+            LOG_ERROR("Failed to map a host-visible page");
+            vkFreeMemory(device, page->memory, nullptr);
+            return nullptr;
+        }
+        page->mapped = static_cast<uint8_t*>(mapped);
+    }
+
+    page->size = size;
+    page->memoryType = memoryType;
+    page->dedicated = dedicated;
+    page->freeRanges.push_back(FreeRange{0, size});
+    pages.push_back(std::move(page));
+    return pages.back().get();
+}
+
+bool VulkanMemoryAllocator::allocateFromPage(Page& page, VkDeviceSize size, VkDeviceSize alignment,
+                                             VulkanAllocation& allocation) {
+    // First fit; the alignment padding at the front of the range stays free
+    for (size_t i = 0; i < page.freeRanges.size(); i++) {
+        FreeRange range = page.freeRanges[i];
+        VkDeviceSize offset = (range.offset + alignment - 1) / alignment * alignment;
+        VkDeviceSize end = offset + size;
+        if (end > range.offset + range.size)
+            continue;
+
+        std::vector<FreeRange> remainder;
+        if (offset > range.offset)
+            remainder.push_back(FreeRange{range.offset, offset - range.offset});
+        if (end < range.offset + range.size)
+            remainder.push_back(FreeRange{end, range.offset + range.size - end});
+        page.freeRanges.erase(page.freeRanges.begin() + i);
+        page.freeRanges.insert(page.freeRanges.begin() + i, remainder.begin(), remainder.end());
+
+        allocation.memory = page.memory;
+        allocation.offset = offset;
+        allocation.size = size;
+        allocation.mapped = page.mapped ? page.mapped + offset : nullptr;
+        page.allocationCount++;
+        return true;
+    }
+    return false;
+}
+
+bool VulkanMemoryAllocator::allocate(const VkMemoryRequirements& requirements,
+                                     VkMemoryPropertyFlags required,
+                                     VkMemoryPropertyFlags preferred,
+                                     VulkanAllocation& allocation) {
+    uint32_t memoryType;
+    if (!findMemoryType(requirements.memoryTypeBits, required, required | preferred,
+                        memoryType)) {
+        LOG_ERROR("No memory type with properties " + std::to_string(required));
+        return false;
+    }
+
+    VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+    VkDeviceSize pageSize = getPageSize(memoryType);
+    if (requirements.size > pageSize / 2) {
+        Page* page = createPage(memoryType, requirements.size, true);
+        return page && allocateFromPage(*page, requirements.size, alignment, allocation);
+    }
+
+    for (auto& page : pages) {
+        if (page->memoryType == memoryType && !page->dedicated &&
+            allocateFromPage(*page, requirements.size, alignment, allocation))
+            return true;
+    }
+
+    Page* page = createPage(memoryType, pageSize, false);
+    return page && allocateFromPage(*page, requirements.size, alignment, allocation);
+}
+
+void VulkanMemoryAllocator::free(VulkanAllocation& allocation) {
+    if (!allocation.memory)
+        return;
+
+    auto it = std::find_if(pages.begin(), pages.end(),
+                           [&](const auto& page) { return page->memory == allocation.memory; });
+    if (it == pages.end()) {
+        // The allocator was destroyed first, taking the page with it
+        allocation = VulkanAllocation();
+        return;
+    }
+
+    Page& page = **it;
+    page.allocationCount--;
+    if (page.dedicated && page.allocationCount == 0) {
+        if (page.mapped)
+            vkUnmapMemory(device, page.memory);
+        vkFreeMemory(device, page.memory, nullptr);
+        pages.erase(it);
+        allocation = VulkanAllocation();
+        return;
+    }
+
+    // Insert in offset order, then merge with the neighbours it touches
+    auto& ranges = page.freeRanges;
+    auto next = std::lower_bound(
+        ranges.begin(), ranges.end(), allocation.offset,
+        [](const FreeRange& range, VkDeviceSize offset) { return range.offset < offset; });
+    size_t index = static_cast<size_t>(next - ranges.begin());
+    ranges.insert(next, FreeRange{allocation.offset, allocation.size});
+    if (index + 1 < ranges.size() &&
+        ranges[index].offset + ranges[index].size == ranges[index + 1].offset) {
+        ranges[index].size += ranges[index + 1].size;
+        ranges.erase(ranges.begin() + index + 1);
+    }
+    if (index > 0 && ranges[index - 1].offset + ranges[index - 1].size == ranges[index].offset) {
+        ranges[index - 1].size += ranges[index].size;
+        ranges.erase(ranges.begin() + index);
+    }
+
+    allocation = VulkanAllocation();
+}
+
+bool VulkanMemoryAllocator::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                         VkMemoryPropertyFlags required, VkBuffer& buffer,
+                                         VulkanAllocation& allocation) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+        return false;
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device, buffer, &requirements);
+    if (!allocate(requirements, required, 0, allocation)) {
+        vkDestroyBuffer(device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+        return false;
+    }
+
+    vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
+    return true;
+}
+
+void VulkanMemoryAllocator::destroyBuffer(VkBuffer& buffer, VulkanAllocation& allocation) {
+    if (buffer) {
+        vkDestroyBuffer(device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+    }
+    free(allocation);
+}
@@ -0,0 +1,77 @@
+#ifndef VULKAN_MEMORY_ALLOCATOR_HPP
+#define VULKAN_MEMORY_ALLOCATOR_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// A range of a VkDeviceMemory page handed out by VulkanMemoryAllocator
+struct VulkanAllocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    // Persistent mapping of the range, for host-visible memory only
+    uint8_t* mapped = nullptr;
+};
+
+// Carves buffers out of large VkDeviceMemory pages, one set of pages per memory type, so
+// a scene costs a handful of vkAllocateMemory calls instead of one per buffer (drivers
+// may cap the total at maxMemoryAllocationCount, often 4096).
+// Each page keeps a sorted free list; frees are coalesced with their neighbours. Requests
+// over half a page get a dedicated page that is released as soon as it is freed.
+// Host-visible pages are mapped once when created. Only buffers are placed here, so
+// bufferImageGranularity never applies.
+class VulkanMemoryAllocator {
+  private:
+    static constexpr VkDeviceSize DEFAULT_PAGE_SIZE = 64ull * 1024 * 1024;
+
+    struct FreeRange {
+        VkDeviceSize offset;
+        VkDeviceSize size;
+    };
+    struct Page {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        uint32_t memoryType = 0;
+        uint8_t* mapped = nullptr;
+        bool dedicated = false;
+        uint32_t allocationCount = 0;
+        std::vector<FreeRange> freeRanges; // sorted by offset
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties memoryProperties{};
+    std::vector<std::unique_ptr<Page>> pages;
+
+    bool findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags required,
+                        VkMemoryPropertyFlags preferred, uint32_t& memoryType) const;
+    VkDeviceSize getPageSize(uint32_t memoryType) const;
+    Page* createPage(uint32_t memoryType, VkDeviceSize size, bool dedicated);
+    static bool allocateFromPage(Page& page, VkDeviceSize size, VkDeviceSize alignment,
+                                 VulkanAllocation& allocation);
+
+  public:
+    VulkanMemoryAllocator() = default;
+    VulkanMemoryAllocator(const VulkanMemoryAllocator&) = delete;
+    VulkanMemoryAllocator& operator=(const VulkanMemoryAllocator&) = delete;
+    ~VulkanMemoryAllocator();
+
+    void init(VkPhysicalDevice physicalDevice, VkDevice device);
+    // Frees every page; outstanding allocations become invalid
+    void destroy();
+
+    // The memory type must have all of required; one that also has preferred wins
+    bool allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags required,
+                  VkMemoryPropertyFlags preferred, VulkanAllocation& allocation);
+    void free(VulkanAllocation& allocation);
+
+    // vkCreateBuffer + allocate + vkBindBufferMemory
+    bool createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags required,
+                      VkBuffer& buffer, VulkanAllocation& allocation);
+    void destroyBuffer(VkBuffer& buffer, VulkanAllocation& allocation);
+
+    size_t getPageCount() const { return pages.size(); }
+};
+
+#endif // VULKAN_MEMORY_ALLOCATOR_HPP
@@ -8,75 +8,44 @@ VulkanMeshBuffer::~VulkanMeshBuffer() {
     destroy();
 }
 
-bool VulkanMeshBuffer::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
-                                   VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
-    
-    VkDevice dev = backend->getDevice();
-    if (dev == VK_NULL_HANDLE) {
+bool VulkanMeshBuffer::createStaticBuffer(const void* data, VkDeviceSize size,
+                                          VkBufferUsageFlags usage, VkBuffer& buffer,
+                                          VulkanAllocation& allocation) {
+    if (backend->getDevice() == VK_NULL_HANDLE) {
         LOG_ERROR("Device is NULL!");
-    }
-    
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = size;
-    bufferInfo.usage = usage;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    
-    if (vkCreateBuffer(backend->getDevice(), &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
         return false;
     }
     
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(backend->getDevice(), buffer, &memRequirements);
-    
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(backend->getPhysicalDevice(), &memProperties);
-    
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((memRequirements.memoryTypeBits & (1 << i)) &&
-            (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            allocInfo.memoryTypeIndex = i;
-            break;
-        }
+    // Static geometry lives in device memory; vertex fetch never reads system memory
+    auto& allocator = backend->getMemoryAllocator();
+    if (!allocator.createBuffer(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, allocation)) {
+        return false;
     }
     
-    if (vkAllocateMemory(backend->getDevice(), &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
+    if (!backend->getStagingRing().upload(buffer, 0, data, size)) {
+        // Chunks queued before the failure may still copy into it
+        backend->deferDestroyBuffer(buffer, allocation);
         return false;
     }
-    
-    vkBindBufferMemory(backend->getDevice(), buffer, bufferMemory, 0);
     return true;
 }
 
-bool VulkanMeshBuffer::createBuffers(const std::vector<float>& vertices, const std::vector<float>& normals) {
-    VkDeviceSize vertexBufferSize = sizeof(float) * vertices.size();
-    VkDeviceSize normalBufferSize = sizeof(float) * normals.size();
+bool VulkanMeshBuffer::createBuffers(const MeshBufferDesc& desc) {
+    VkDeviceSize vertexBufferSize =
+        static_cast<VkDeviceSize>(desc.vertexCount) * desc.layout.stride;
     
-    if (!createBuffer(vertexBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     vertexBuffer, vertexBufferMemory)) {
+    if (!createStaticBuffer(desc.vertices, vertexBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                            vertexBuffer, vertexAllocation)) {
         return false;
     }
     
-    void* data;
-    vkMapMemory(backend->getDevice(), vertexBufferMemory, 0, vertexBufferSize, 0, &data);
-    memcpy(data, vertices.data(), vertexBufferSize);
-    vkUnmapMemory(backend->getDevice(), vertexBufferMemory);
-    
-    if (!normals.empty()) {
-        if (!createBuffer(normalBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                         normalBuffer, normalBufferMemory)) {
+    if (desc.indices && desc.indexCount > 0) {
+        VkDeviceSize indexBufferSize = desc.indexCount * getIndexSize(desc.indexType);
+        if (!createStaticBuffer(desc.indices, indexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                                indexBuffer, indexAllocation)) {
             return false;
         }
-        
-        vkMapMemory(backend->getDevice(), normalBufferMemory, 0, normalBufferSize, 0, &data);
-        memcpy(data, normals.data(), normalBufferSize);
-        vkUnmapMemory(backend->getDevice(), normalBufferMemory);
     }
     
     return true;
@@ -91,22 +60,9 @@ void VulkanMeshBuffer::unbind() {
 }
 
 void VulkanMeshBuffer::destroy() {
-    if (vertexBuffer) {
-        vkDestroyBuffer(backend->getDevice(), vertexBuffer, nullptr);
-        vertexBuffer = VK_NULL_HANDLE;
-    }
-    if (vertexBufferMemory) {
-        vkFreeMemory(backend->getDevice(), vertexBufferMemory, nullptr);
-        vertexBufferMemory = VK_NULL_HANDLE;
-    }
-    if (normalBuffer) {
-        vkDestroyBuffer(backend->getDevice(), normalBuffer, nullptr);
-        normalBuffer = VK_NULL_HANDLE;
-    }
-    if (normalBufferMemory) {
-        vkFreeMemory(backend->getDevice(), normalBufferMemory, nullptr);
-        normalBufferMemory = VK_NULL_HANDLE;
-    }
+    // Frames in flight and unflushed staging copies may still use them
+    backend->deferDestroyBuffer(vertexBuffer, vertexAllocation);
+    backend->deferDestroyBuffer(indexBuffer, indexAllocation);
 }
 
 void* VulkanMeshBuffer::getHandle() const {
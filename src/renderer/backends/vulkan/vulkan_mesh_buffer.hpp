@@ -2,6 +2,7 @@
 #define VULKAN_MESH_BUFFER_HPP
 
 #include "mesh_buffer.hpp"
+#include "vulkan_memory_allocator.hpp"
 #include <vulkan/vulkan.h>
 
 class VulkanRendererBackend;
@@ -10,25 +11,26 @@ class VulkanMeshBuffer : public MeshBuffer {
 private:
     VulkanRendererBackend* backend;
     VkBuffer vertexBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
-    VkBuffer normalBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory normalBufferMemory = VK_NULL_HANDLE;
+    VulkanAllocation vertexAllocation;
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    VulkanAllocation indexAllocation;
     
-    bool createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, 
-                     VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+    // Creates a DEVICE_LOCAL buffer and queues its contents on the backend's staging ring
+    bool createStaticBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage,
+                            VkBuffer& buffer, VulkanAllocation& allocation);
     
 public:
     VulkanMeshBuffer(VulkanRendererBackend* backend) : backend(backend) {}
     ~VulkanMeshBuffer();
     
-    bool createBuffers(const std::vector<float>& vertices, const std::vector<float>& normals) override;
+    bool createBuffers(const MeshBufferDesc& desc) override;
     void bind() override;
     void unbind() override;
     void destroy() override;
     void* getHandle() const override;
     
     VkBuffer getVertexBuffer() const { return vertexBuffer; }
-    VkBuffer getNormalBuffer() const { return normalBuffer; }
+    VkBuffer getIndexBuffer() const { return indexBuffer; }
 };
 
 #endif // VULKAN_MESH_BUFFER_HPP
@@ -0,0 +1,61 @@
+#define CLASS_NAME "VulkanPipelineCompiler"
+#include "log_macros.hpp"
+
+#include "vulkan_pipeline_compiler.hpp"
+#include <algorithm>
+#include <string>
+
+VulkanPipelineCompiler::~VulkanPipelineCompiler() { stop(); }
+
+void VulkanPipelineCompiler::start(uint32_t threadCount) {
+    stop();
+    if (threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    stopping = false;
+    for (uint32_t i = 0; i < threadCount; i++)
+        workers.emplace_back(&VulkanPipelineCompiler::run, this);
+    LOG_INFO("Building pipelines on " + std::to_string(threadCount) + " worker threads");
+}
+
+void VulkanPipelineCompiler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+std::future<bool> VulkanPipelineCompiler::submit(std::function<bool()> job) {
+    std::packaged_task<bool()> task(std::move(job));
+    std::future<bool> result = task.get_future();
+    if (workers.empty()) {
+        task();
+        return result;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(task));
+    }
+    wake.notify_one();
+    return result;
+}
+
+void VulkanPipelineCompiler::run() {
+    for (;;) {
+        std::packaged_task<bool()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+                return;
+            task = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef VULKAN_PIPELINE_COMPILER_HPP
+#define VULKAN_PIPELINE_COMPILER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker threads that build shader modules and pipelines away from the render thread.
+// Programs submit their whole build when linked and poll the returned future each frame,
+// so a scene's pipelines compile in parallel while the loader keeps going.
+// vkCreateShaderModule, vkCreatePipelineLayout and vkCreateGraphicsPipelines are free-
+// threaded, and the backend's VkPipelineCache is internally synchronized.
+class VulkanPipelineCompiler {
+  private:
+    std::vector<std::thread> workers;
+    std::deque<std::packaged_task<bool()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void run();
+
+  public:
+    VulkanPipelineCompiler() = default;
+    VulkanPipelineCompiler(const VulkanPipelineCompiler&) = delete;
+    VulkanPipelineCompiler& operator=(const VulkanPipelineCompiler&) = delete;
+    ~VulkanPipelineCompiler();
+
+    // 0 picks one thread per core but one, leaving the render thread its own core
+    void start(uint32_t threadCount = 0);
+    // Finishes every queued job, then joins the workers
+    void stop();
+
+    // Runs job on a worker; inline when no workers are running
+    std::future<bool> submit(std::function<bool()> job);
+};
+
+#endif // VULKAN_PIPELINE_COMPILER_HPP
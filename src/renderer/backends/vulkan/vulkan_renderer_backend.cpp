@@ -3,6 +3,7 @@
 #define CLASS_NAME "VulkanRendererBackend"
 #include "../../../log_macros.hpp"
 
+#include "renderer/shader_cache_file.hpp"
 #include "shader_program_factory.hpp"
 #include "vulkan_mesh_buffer.hpp"
 #include "vulkan_renderer_backend.hpp"
@@ -10,6 +11,7 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_vulkan.h>
 #include <SDL_video.h>
+#include <algorithm>
 #include <array>
 #include <cstdio>
 #include <cstring>
@@ -38,15 +40,24 @@ std::unique_ptr<ShaderCompiler> VulkanRendererBackend::createShaderCompiler() {
 }
 
 VulkanRendererBackend::~VulkanRendererBackend() {
+    pipelineCompiler.stop();
     if (device) {
         vkDeviceWaitIdle(device);
 
-        if (inFlightFence)
-            vkDestroyFence(device, inFlightFence, nullptr);
-        if (renderFinishedSemaphore)
-            vkDestroySemaphore(device, renderFinishedSemaphore, nullptr);
-        if (imageAvailableSemaphore)
-            vkDestroySemaphore(device, imageAvailableSemaphore, nullptr);
+        stagingRing.destroy();
+        destroyDeletions(pendingDeletions);
+        for (auto& frame : frames) {
+            destroyDeletions(frame.deletions);
+            memoryAllocator.destroyBuffer(frame.uniformBuffer, frame.uniformAllocation);
+            if (frame.inFlight)
+                vkDestroyFence(device, frame.inFlight, nullptr);
+            if (frame.imageAvailable)
+                vkDestroySemaphore(device, frame.imageAvailable, nullptr);
+        }
+        for (auto semaphore : renderFinishedSemaphores) {
+            if (semaphore)
+                vkDestroySemaphore(device, semaphore, nullptr);
+        }
 
         if (commandPool)
             vkDestroyCommandPool(device, commandPool, nullptr);
@@ -69,18 +80,10 @@ VulkanRendererBackend::~VulkanRendererBackend() {
         if (depthImageMemory)
             vkFreeMemory(device, depthImageMemory, nullptr);
 
-        if (uniformBuffer)
-            vkDestroyBuffer(device, uniformBuffer, nullptr);
-        if (uniformBufferMemory)
-            vkFreeMemory(device, uniformBufferMemory, nullptr);
-        if (materialBuffer)
-            vkDestroyBuffer(device, materialBuffer, nullptr);
-        if (materialBufferMemory)
-            vkFreeMemory(device, materialBufferMemory, nullptr);
-        if (lightDataBuffer)
-            vkDestroyBuffer(device, lightDataBuffer, nullptr);
-        if (lightDataBufferMemory)
-            vkFreeMemory(device, lightDataBufferMemory, nullptr);
+
+        savePipelineCache();
+        if (pipelineCache)
+            vkDestroyPipelineCache(device, pipelineCache, nullptr);
 
         if (descriptorPool)
             vkDestroyDescriptorPool(device, descriptorPool, nullptr);
@@ -89,6 +92,8 @@ VulkanRendererBackend::~VulkanRendererBackend() {
 
         if (swapchain)
             vkDestroySwapchainKHR(device, swapchain, nullptr);
+        // Mesh buffers still alive past this point find their pages gone and skip the free
+        memoryAllocator.destroy();
         vkDestroyDevice(device, nullptr);
     }
 
@@ -102,6 +107,10 @@ unsigned int VulkanRendererBackend::getRequiredWindowFlags() const { return SDL_
 
 bool VulkanRendererBackend::init(SDL_Window* window) { return true; };
 
+void VulkanRendererBackend::setFramesInFlight(uint32_t count) {
+    framesInFlight = std::clamp<uint32_t>(count, 1, MAX_FRAMES_IN_FLIGHT);
+}
+
 bool VulkanRendererBackend::initWindowContext() {
     printf("[Vulkan] initWindowContext - creating instance\n");
     return createInstance();
@@ -117,6 +126,12 @@ bool VulkanRendererBackend::init() {
         printf("Failed to create logical device\n");
         return false;
     }
+    memoryAllocator.init(physicalDevice, device);
+    if (!createPipelineCache()) {
+        printf("Failed to create pipeline cache\n");
+        return false;
+    }
+    pipelineCompiler.start();
     if (!createSwapchain()) {
         printf("Failed to create swapchain\n");
         return false;
@@ -141,20 +156,17 @@ bool VulkanRendererBackend::init() {
         printf("Failed to create command pool\n");
         return false;
     }
-    if (!createDescriptorSetLayout()) {
-        printf("Failed to create descriptor set layout\n");
+    if (!stagingRing.init(device, graphicsQueue, commandPool, memoryAllocator)) {
+        printf("Failed to create staging ring\n");
         return false;
     }
-    if (!createUniformBuffer()) {
-        printf("Failed to create uniform buffer\n");
-        return false;
-    }
-    if (!createMaterialBuffer()) {
-        printf("Failed to create material buffer\n");
+    if (!createDescriptorSetLayout()) {
+        printf("Failed to create descriptor set layout\n");
         return false;
     }
-    if (!createLightDataBuffer()) {
-        printf("Failed to create light data buffer\n");
+    frames.assign(framesInFlight, FrameResources());
+    if (!createUniformBuffers()) {
+        printf("Failed to create uniform buffers\n");
         return false;
     }
     if (!createDescriptorPool()) {
@@ -170,7 +182,7 @@ bool VulkanRendererBackend::init() {
         return false;
     }
 
-    printf("[Vulkan] Initialization complete!\n");
+    printf("[Vulkan] Initialization complete, %u frames in flight\n", framesInFlight);
     return true;
 }
 
@@ -282,6 +294,57 @@ bool VulkanRendererBackend::createLogicalDevice() {
     return true;
 }
 
+bool VulkanRendererBackend::createPipelineCache() {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    // Drivers should reject foreign data themselves, but not all of them do; only seed the
+    // cache with data written by this exact device and driver build
+    std::vector<uint8_t> data;
+    if (ShaderCacheFile::read(PIPELINE_CACHE_FILE, data)) {
+        VkPipelineCacheHeaderVersionOne header{};
+        bool valid = data.size() >= sizeof(header);
+        if (valid) {
+            std::memcpy(&header, data.data(), sizeof(header));
+            valid = header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                    header.headerSize >= sizeof(header) && header.headerSize <= data.size() &&
+                    header.vendorID == properties.vendorID &&
+                    header.deviceID == properties.deviceID &&
+                    std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID,
+                                VK_UUID_SIZE) == 0;
+        }
+        if (!valid) {
+            LOG_INFO("Pipeline cache was written by another device or driver; starting empty");
+            data.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+    if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache) == VK_SUCCESS)
+        return true;
+
+    // Corrupt data that passed the header check; an empty cache still works
+    cacheInfo.initialDataSize = 0;
+    cacheInfo.pInitialData = nullptr;
+    return vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache) == VK_SUCCESS;
+}
+
+void VulkanRendererBackend::savePipelineCache() {
+    if (!pipelineCache)
+        return;
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device, pipelineCache, &size, nullptr) != VK_SUCCESS || size == 0)
+        return;
+    std::vector<uint8_t> data(size);
+    if (vkGetPipelineCacheData(device, pipelineCache, &size, data.data()) != VK_SUCCESS)
+        return;
+    ShaderCacheFile::write(PIPELINE_CACHE_FILE, data.data(), size);
+}
+
 bool VulkanRendererBackend::createSwapchain() {
     VkSurfaceCapabilitiesKHR capabilities;
     vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &capabilities);
@@ -429,8 +492,9 @@ bool VulkanRendererBackend::createDescriptorSetLayout() {
     bindings[0].descriptorCount = 1;
     bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
+    // MaterialData, one slot per material write; see uniformBlockOffsets
     bindings[1].binding = 1;
-    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     bindings[1].descriptorCount = 1;
     bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
@@ -532,183 +596,169 @@ bool VulkanRendererBackend::createDepthResources() {
     return vkCreateImageView(device, &viewInfo, nullptr, &depthImageView) == VK_SUCCESS;
 }
 
-bool VulkanRendererBackend::createUniformBuffer() {
+bool VulkanRendererBackend::createUniformBuffers() {
     if (device == VK_NULL_HANDLE) {
-        LOG_WARN("Device is null in createUniformBuffer\n");
+        LOG_WARN("Device is null in createUniformBuffers\n");
         return false;
     }
 
-    VkDeviceSize bufferSize = 4 * sizeof(glm::mat4);
-
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = bufferSize;
-    bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    if (vkCreateBuffer(device, &bufferInfo, nullptr, &uniformBuffer) != VK_SUCCESS) {
-        return false;
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    VkDeviceSize alignment = std::max<VkDeviceSize>(
+        properties.limits.minUniformBufferOffsetAlignment, 16);
+    auto alignUp = [alignment](VkDeviceSize size) {
+        return (size + alignment - 1) / alignment * alignment;
+    };
+
+    auto materialIndex = static_cast<uint32_t>(UniformBlock::MATERIAL_DATA);
+    VkDeviceSize staticSize = 0;
+    for (uint32_t block = 0; block < UNIFORM_BLOCK_COUNT; block++) {
+        if (block == materialIndex)
+            continue;
+        uniformBlockOffsets[block] = staticSize;
+        staticSize += alignUp(UNIFORM_BLOCK_SIZES[block]);
     }
+    uniformBlockOffsets[materialIndex] = staticSize;
+    materialStride = alignUp(UNIFORM_BLOCK_SIZES[materialIndex]);
 
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(device, uniformBuffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex =
-        findMemoryType(memRequirements.memoryTypeBits,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &uniformBufferMemory) != VK_SUCCESS) {
-        return false;
+    for (auto& frame : frames) {
+        if (!createFrameUniformBuffer(frame, DEFAULT_MATERIAL_SLOTS))
+            return false;
+        std::memset(frame.uniformAllocation.mapped, 0,
+                    uniformBlockOffsets[materialIndex] + materialStride * frame.materialSlots);
     }
-
-    vkBindBufferMemory(device, uniformBuffer, uniformBufferMemory, 0);
     return true;
 }
 
-bool VulkanRendererBackend::createMaterialBuffer() {
-    VkDeviceSize bufferSize = sizeof(float) * 4;
-
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = bufferSize;
-    bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+bool VulkanRendererBackend::createFrameUniformBuffer(FrameResources& frame,
+                                                     uint32_t materialSlots) {
+    auto materialIndex = static_cast<uint32_t>(UniformBlock::MATERIAL_DATA);
+    VkDeviceSize size = uniformBlockOffsets[materialIndex] + materialStride * materialSlots;
 
-    if (vkCreateBuffer(device, &bufferInfo, nullptr, &materialBuffer) != VK_SUCCESS) {
+    // Host-visible pages are persistently mapped, so writes are plain memcpys
+    if (!memoryAllocator.createBuffer(size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                          VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                      frame.uniformBuffer, frame.uniformAllocation)) {
         return false;
     }
-
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(device, materialBuffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex =
-        findMemoryType(memRequirements.memoryTypeBits,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &materialBufferMemory) != VK_SUCCESS) {
-        return false;
-    }
-
-    vkBindBufferMemory(device, materialBuffer, materialBufferMemory, 0);
+    frame.materialSlots = materialSlots;
     return true;
 }
 
-bool VulkanRendererBackend::createLightDataBuffer() {
-    VkDeviceSize bufferSize = sizeof(float) * 3;
-
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = bufferSize;
-    bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    if (vkCreateBuffer(device, &bufferInfo, nullptr, &lightDataBuffer) != VK_SUCCESS) {
+bool VulkanRendererBackend::reserveMaterialSlots(uint32_t count) {
+    FrameResources& frame = frames[currentFrame];
+    if (count <= frame.materialSlots)
+        return true;
+    requiredMaterialSlots = std::max(requiredMaterialSlots, count);
+    // Outside a frame the slot's fence has not been waited on, and once the descriptor set is
+    // bound the recorded draws point at the current buffer
+    if (!frameActive || descriptorSetBound)
         return false;
-    }
-
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(device, lightDataBuffer, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex =
-        findMemoryType(memRequirements.memoryTypeBits,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &lightDataBufferMemory) != VK_SUCCESS) {
+    // The slot's previous submission has signaled its fence and nothing recorded this frame
+    // references the buffer yet, so the old one can be copied and freed right away
+    FrameResources grown;
+    uint32_t slots = std::max(count, frame.materialSlots * 2);
+    if (!createFrameUniformBuffer(grown, slots)) {
+        LOG_ERROR("Failed to grow the uniform buffer to " + std::to_string(slots) +
+                  " material slots");
         return false;
     }
-
-    vkBindBufferMemory(device, lightDataBuffer, lightDataBufferMemory, 0);
+    auto materialIndex = static_cast<uint32_t>(UniformBlock::MATERIAL_DATA);
+    std::memcpy(grown.uniformAllocation.mapped, frame.uniformAllocation.mapped,
+                uniformBlockOffsets[materialIndex] + materialStride * frame.materialSlots);
+    memoryAllocator.destroyBuffer(frame.uniformBuffer, frame.uniformAllocation);
+    frame.uniformBuffer = grown.uniformBuffer;
+    frame.uniformAllocation = grown.uniformAllocation;
+    frame.materialSlots = grown.materialSlots;
+    writeFrameDescriptors(frame);
+    LOG_INFO("Grew frame " + std::to_string(currentFrame) + " to " + std::to_string(slots) +
+             " material slots");
     return true;
 }
 
 bool VulkanRendererBackend::createDescriptorPool() {
-    VkDescriptorPoolSize poolSize{};
-    poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSize.descriptorCount = 3;
+    uint32_t staticBlocks = 0;
+    for (uint32_t block = 0; block < UNIFORM_BLOCK_COUNT; block++) {
+        if (UNIFORM_BLOCK_SIZES[block] > 0 &&
+            static_cast<UniformBlock>(block) != UniformBlock::MATERIAL_DATA)
+            staticBlocks++;
+    }
+
+    VkDescriptorPoolSize poolSizes[2] = {};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount = staticBlocks * framesInFlight;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSizes[1].descriptorCount = framesInFlight;
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = 1;
-    poolInfo.pPoolSizes = &poolSize;
-    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 2;
+    poolInfo.pPoolSizes = poolSizes;
+    poolInfo.maxSets = framesInFlight;
 
     if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
         return false;
     }
 
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = descriptorPool;
-    allocInfo.descriptorSetCount = 1;
-    allocInfo.pSetLayouts = &descriptorSetLayout;
+    // One set per frame, pointing at that frame's uniform buffer
+    for (uint32_t i = 0; i < framesInFlight; i++) {
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &descriptorSetLayout;
 
-    descriptorSets.resize(1);
-    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
-        return false;
+        if (vkAllocateDescriptorSets(device, &allocInfo, &frames[i].descriptorSet) != VK_SUCCESS) {
+            return false;
+        }
+        writeFrameDescriptors(frames[i]);
     }
 
-    VkDescriptorBufferInfo bufferInfos[3] = {};
-    bufferInfos[0].buffer = uniformBuffer;
-    bufferInfos[0].offset = 0;
-    bufferInfos[0].range = 4 * sizeof(glm::mat4);
-
-    bufferInfos[1].buffer = materialBuffer;
-    bufferInfos[1].offset = 0;
-    bufferInfos[1].range = sizeof(float) * 4;
-
-    bufferInfos[2].buffer = lightDataBuffer;
-    bufferInfos[2].offset = 0;
-    bufferInfos[2].range = sizeof(float) * 3;
-
-    VkWriteDescriptorSet descriptorWrites[3] = {};
-    descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[0].dstSet = descriptorSets[0];
-    descriptorWrites[0].dstBinding = 0;
-    descriptorWrites[0].dstArrayElement = 0;
-    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptorWrites[0].descriptorCount = 1;
-    descriptorWrites[0].pBufferInfo = &bufferInfos[0];
-
-    descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[1].dstSet = descriptorSets[0];
-    descriptorWrites[1].dstBinding = 1;
-    descriptorWrites[1].dstArrayElement = 0;
-    descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptorWrites[1].descriptorCount = 1;
-    descriptorWrites[1].pBufferInfo = &bufferInfos[1];
-
-    descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[2].dstSet = descriptorSets[0];
-    descriptorWrites[2].dstBinding = 2;
-    descriptorWrites[2].dstArrayElement = 0;
-    descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptorWrites[2].descriptorCount = 1;
-    descriptorWrites[2].pBufferInfo = &bufferInfos[2];
-
-    vkUpdateDescriptorSets(device, 3, descriptorWrites, 0, nullptr);
-
     return true;
 }
 
-bool VulkanRendererBackend::createCommandBuffers() {
-    commandBuffers.resize(framebuffers.size());
+void VulkanRendererBackend::writeFrameDescriptors(FrameResources& frame) {
+    VkDescriptorBufferInfo bufferInfos[UNIFORM_BLOCK_COUNT] = {};
+    VkWriteDescriptorSet descriptorWrites[UNIFORM_BLOCK_COUNT] = {};
+    uint32_t writeCount = 0;
+    for (uint32_t block = 0; block < UNIFORM_BLOCK_COUNT; block++) {
+        if (UNIFORM_BLOCK_SIZES[block] == 0)
+            continue;
+        VkDescriptorType type = static_cast<UniformBlock>(block) == UniformBlock::MATERIAL_DATA
+                                    ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
+                                    : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        VkDescriptorBufferInfo& bufferInfo = bufferInfos[writeCount];
+        bufferInfo.buffer = frame.uniformBuffer;
+        bufferInfo.offset = uniformBlockOffsets[block];
+        bufferInfo.range = UNIFORM_BLOCK_SIZES[block];
+
+        VkWriteDescriptorSet& write = descriptorWrites[writeCount++];
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = frame.descriptorSet;
+        write.dstBinding = block;
+        write.dstArrayElement = 0;
+        write.descriptorType = type;
+        write.descriptorCount = 1;
+        write.pBufferInfo = &bufferInfo;
+    }
 
+    vkUpdateDescriptorSets(device, writeCount, descriptorWrites, 0, nullptr);
+}
+
+bool VulkanRendererBackend::createCommandBuffers() {
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.commandPool = commandPool;
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = (uint32_t)commandBuffers.size();
+    allocInfo.commandBufferCount = 1;
 
-    return vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) == VK_SUCCESS;
+    for (auto& frame : frames) {
+        if (vkAllocateCommandBuffers(device, &allocInfo, &frame.commandBuffer) != VK_SUCCESS)
+            return false;
+    }
+    return true;
 }
 
 bool VulkanRendererBackend::createSyncObjects() {
@@ -719,11 +769,21 @@ bool VulkanRendererBackend::createSyncObjects() {
     fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    return vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphore) ==
-               VK_SUCCESS &&
-           vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphore) ==
-               VK_SUCCESS &&
-           vkCreateFence(device, &fenceInfo, nullptr, &inFlightFence) == VK_SUCCESS;
+    // Fences start signaled so the first wait on each frame slot returns immediately
+    for (auto& frame : frames) {
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &frame.imageAvailable) !=
+                VK_SUCCESS ||
+            vkCreateFence(device, &fenceInfo, nullptr, &frame.inFlight) != VK_SUCCESS)
+            return false;
+    }
+
+    renderFinishedSemaphores.assign(swapchainImages.size(), VK_NULL_HANDLE);
+    for (auto& semaphore : renderFinishedSemaphores) {
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS)
+            return false;
+    }
+    imagesInFlight.assign(swapchainImages.size(), VK_NULL_HANDLE);
+    return true;
 }
 
 uint32_t VulkanRendererBackend::findMemoryType(uint32_t typeFilter,
@@ -744,18 +804,66 @@ void VulkanRendererBackend::onCameraSet() {
     // Atualizar clear color se necessário
 }
 
-void VulkanRendererBackend::clear(Camera* camera) {
-    vkWaitForFences(device, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
-    vkResetFences(device, 1, &inFlightFence);
+void VulkanRendererBackend::beginFrame() {
+    frameActive = false;
+    if (frames.empty())
+        return;
 
-    vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imageAvailableSemaphore, VK_NULL_HANDLE,
-                          &currentImageIndex);
+    // Only waits for the GPU to finish the frame that last used this slot,
+    // framesInFlight - 1 frames ago, so recording overlaps the frames still executing
+    FrameResources& frame = frames[currentFrame];
+    vkWaitForFences(device, 1, &frame.inFlight, VK_TRUE, UINT64_MAX);
+    stagingRing.retire();
+    destroyDeletions(frame.deletions);
+
+    VkResult result = vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, frame.imageAvailable,
+                                            VK_NULL_HANDLE, &currentImageIndex);
+    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+        LOG_ERROR("Failed to acquire a swapchain image: " + std::to_string(result));
+        return;
+    }
+
+    // The image may be returned while an older frame still renders into it
+    VkFence& imageFence = imagesInFlight[currentImageIndex];
+    if (imageFence != VK_NULL_HANDLE && imageFence != frame.inFlight)
+        vkWaitForFences(device, 1, &imageFence, VK_TRUE, UINT64_MAX);
+    imageFence = frame.inFlight;
 
-    vkResetCommandBuffer(commandBuffers[currentImageIndex], 0);
+    // Reset only once a submit is certain to follow, or the next wait would never return
+    vkResetFences(device, 1, &frame.inFlight);
+    // That submit's fence also covers every earlier submission on the queue, including the
+    // staging copies present() flushes ahead of it
+    frame.deletions.swap(pendingDeletions);
+    vkResetCommandBuffer(frame.commandBuffer, 0);
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    vkBeginCommandBuffer(commandBuffers[currentImageIndex], &beginInfo);
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(frame.commandBuffer, &beginInfo);
+    materialWrites = 0;
+    materialOffset = 0;
+    descriptorSetBound = false;
+    frameActive = true;
+    // Catch up with a previous frame that ran out of MaterialData slots
+    reserveMaterialSlots(requiredMaterialSlots);
+}
+
+void VulkanRendererBackend::deferDestroyBuffer(VkBuffer& buffer, VulkanAllocation& allocation) {
+    if (buffer || allocation.memory)
+        pendingDeletions.push_back({buffer, allocation});
+    buffer = VK_NULL_HANDLE;
+    allocation = VulkanAllocation();
+}
+
+void VulkanRendererBackend::destroyDeletions(std::vector<PendingDeletion>& deletions) {
+    for (auto& deletion : deletions)
+        memoryAllocator.destroyBuffer(deletion.buffer, deletion.allocation);
+    deletions.clear();
+}
+
+void VulkanRendererBackend::clear(Camera* camera) {
+    if (!frameActive)
+        return;
 
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -776,70 +884,176 @@ void VulkanRendererBackend::clear(Camera* camera) {
     renderPassInfo.clearValueCount = clearValues.size();
     renderPassInfo.pClearValues = clearValues.data();
 
-    vkCmdBeginRenderPass(commandBuffers[currentImageIndex], &renderPassInfo,
-                         VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(getCommandBuffer(), &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 }
 
 void VulkanRendererBackend::draw(const Mesh& mesh) {
+    if (!frameActive)
+        return;
+
+    VkCommandBuffer commandBuffer = getCommandBuffer();
     auto* vkMeshBuffer = static_cast<VulkanMeshBuffer*>(mesh.getMeshBuffer());
-    VkBuffer vertexBuffers[] = {vkMeshBuffer->getVertexBuffer(), vkMeshBuffer->getNormalBuffer()};
-    VkDeviceSize offsets[] = {0, 0};
-    vkCmdBindVertexBuffers(commandBuffers[currentImageIndex], 0, 2, vertexBuffers, offsets);
-    vkCmdDraw(commandBuffers[currentImageIndex], mesh.getVertices().size() / 3, 1, 0, 0);
+    VkBuffer vertexBuffer = vkMeshBuffer->getVertexBuffer();
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+    if (mesh.isIndexed()) {
+        VkIndexType indexType = mesh.getIndexType() == IndexType::UINT16 ? VK_INDEX_TYPE_UINT16
+                                                                         : VK_INDEX_TYPE_UINT32;
+        vkCmdBindIndexBuffer(commandBuffer, vkMeshBuffer->getIndexBuffer(), 0, indexType);
+        vkCmdDrawIndexed(commandBuffer, mesh.getIndexCount(), 1, 0, 0, 0);
+    } else {
+        vkCmdDraw(commandBuffer, mesh.getVertexCount(), 1, 0, 0);
+    }
 }
 
-void VulkanRendererBackend::setUniforms(ShaderProgram* shaderProgram) {
-    if (!mainCamera)
+void VulkanRendererBackend::bindCamera(Camera* camera) {
+    if (!camera) {
+        LOG_ERROR("Camera is null");
         return;
+    }
 
-    WorldObject* cameraObj = mainCamera->getOwner();
-    if (!cameraObj)
+    WorldObject* cameraObj = camera->getOwner();
+    if (!cameraObj) {
+        LOG_ERROR("Camera has no owner WorldObject");
         return;
-
-    // Bind pipeline do material atual
-    auto* program = static_cast<ShaderProgram*>(shaderProgram);
-    if (program && program->isValid()) {
-        VkPipeline pipeline = static_cast<VkPipeline>(program->getHandle());
-        vkCmdBindPipeline(commandBuffers[currentImageIndex], VK_PIPELINE_BIND_POINT_GRAPHICS,
-                          pipeline);
-
-        // Bind descriptor sets usando o pipeline layout do material
-        auto* vkProgram = static_cast<VulkanShaderProgram*>(program);
-        VkPipelineLayout layout = vkProgram->getPipelineLayout();
-        vkCmdBindDescriptorSets(commandBuffers[currentImageIndex], VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                layout, 0, 1, &descriptorSets[0], 0, nullptr);
     }
 
-    glm::mat4 model = glm::rotate(glm::mat4(1.0f), 0.0f, glm::vec3(1.0f, 0.0f, 1.0f));
-    model = glm::rotate(model, SDL_GetTicks() / 1000.0f, glm::vec3(0.5f, 1.0f, 0.0f));
+    const auto camPos = cameraObj->getTransform().getPosition();
+    const auto camRot = cameraObj->getTransform().getRotation();
 
-    const auto camPos = cameraObj->getTransform().getPosition();          // CORRIGIR AQUI
-    glm::mat4 view = glm::lookAt(glm::vec3(camPos.x, camPos.y, camPos.z), // CORRIGIR AQUI
-                                 glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    // Same camera convention as the OpenGL backend: forward is -Z after yaw and pitch
+    float yawRad = glm::radians(camRot.y);
+    float pitchRad = glm::radians(camRot.x);
+    glm::vec3 forward(cos(pitchRad) * sin(yawRad), sin(pitchRad), cos(pitchRad) * cos(yawRad));
+    forward = -glm::normalize(forward);
 
-    glm::mat4 projection =
-        glm::perspective(glm::radians(mainCamera->getFov()), mainCamera->getAspectRatio(),
-                         mainCamera->getNearDistance(), mainCamera->getFarDistance());
+    glm::vec3 camPosVec(camPos.x, camPos.y, camPos.z);
+    glm::mat4 view = glm::lookAt(camPosVec, camPosVec + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+
+    glm::mat4 projection;
+    if (camera->isOrthographic()) {
+        float orthoSize = camera->getOrthoSize();
+        float aspect = camera->getAspectRatio();
+        projection = glm::ortho(-orthoSize * aspect, orthoSize * aspect, -orthoSize, orthoSize,
+                                camera->getNearDistance(), camera->getFarDistance());
+    } else {
+        projection = glm::perspective(glm::radians(camera->getFov()), camera->getAspectRatio(),
+                                      camera->getNearDistance(), camera->getFarDistance());
+    }
     // fix temporario pra deixar eixo y igual opengl
     projection[1][1] *= -1;
 
-    struct UniformBufferObject {
+    setViewProjection(view, projection);
+
+    // Written once per frame; the model matrix of each draw is pushed instead
+    struct MatricesBlock {
         glm::mat4 model;
         glm::mat4 view;
         glm::mat4 projection;
-    } ubo;
+    } matrices{glm::mat4(1.0f), view, projection};
+    writeUniformBlock(UniformBlock::MODEL_VIEW_PROJECTION, &matrices, sizeof(matrices));
+}
 
-    ubo.model = model;
-    ubo.view = view;
-    ubo.projection = projection;
+void VulkanRendererBackend::writeUniformBlock(UniformBlock block, const void* data,
+                                              size_t size) {
+    // Outside a frame (e.g. Material::init during scene load) the slot's previous submission
+    // may still read its buffer; renderWorldObjects rewrites every block it needs anyway
+    if (!frameActive)
+        return;
 
-    void* data;
-    vkMapMemory(device, uniformBufferMemory, 0, sizeof(ubo), 0, &data);
-    memcpy(data, &ubo, sizeof(ubo));
-    vkUnmapMemory(device, uniformBufferMemory);
+    auto index = static_cast<uint32_t>(block);
+    if (UNIFORM_BLOCK_SIZES[index] == 0)
+        return;
+    uint8_t* target = frames[currentFrame].uniformAllocation.mapped + uniformBlockOffsets[index];
+    size = std::min<size_t>(size, UNIFORM_BLOCK_SIZES[index]);
+    if (block == UniformBlock::MATERIAL_DATA) {
+        // A fresh slot per write: draws already recorded this frame still point at theirs
+        if (!reserveMaterialSlots(materialWrites + 1)) {
+            if (!materialOverflowReported) {
+                LOG_WARN("Out of material slots after draws were recorded; skipping material "
+                         "writes until the uniform buffer grows next frame");
+                materialOverflowReported = true;
+            }
+            return;
+        }
+        materialOffset = static_cast<uint32_t>(materialWrites++ * materialStride);
+        target += materialOffset;
+    }
+    std::memcpy(target, data, size);
 }
 
-unsigned int VulkanRendererBackend::createCubemapTexture(const std::vector<std::string>& faces) {
+void VulkanRendererBackend::bindDescriptorSet(VkPipelineLayout layout) {
+    vkCmdBindDescriptorSets(getCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1,
+                            &frames[currentFrame].descriptorSet, 1, &materialOffset);
+    descriptorSetBound = true;
+}
+
+void VulkanRendererBackend::setUniforms(ShaderProgram* shaderProgram) {
+    if (!frameActive || !shaderProgram || !shaderProgram->isValid())
+        return;
+
+    auto* program = static_cast<VulkanShaderProgram*>(shaderProgram);
+    vkCmdBindPipeline(getCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, program->getPipeline());
+}
+
+void VulkanRendererBackend::applyMaterial(Material* material) {
+    if (material)
+        setUniforms(material->getShaderProgram());
+}
+
+void VulkanRendererBackend::renderWorldObjects(const RenderQueue& queue,
+                                               const std::vector<Light*>& lights) {
+    if (!frameActive)
+        return;
+
+    VkCommandBuffer commandBuffer = getCommandBuffer();
+    const ShaderProgram* currentProgram = nullptr;
+    const Material* currentMaterial = nullptr;
+    bool lightsApplied = false;
+
+    // Every material change takes a slot, so the queue size bounds this frame's writes.
+    // Growing here, before the first bind, keeps writeUniformBlock's overflow path unreachable
+    reserveMaterialSlots(materialWrites + static_cast<uint32_t>(queue.size()));
+
+    for (size_t i = 0; i < queue.size(); i++) {
+        const auto& item = queue[i];
+        // Sprites need textures, which this backend does not upload yet
+        if (!item.mesh)
+            continue;
+
+        auto* program = static_cast<VulkanShaderProgram*>(item.material->getShaderProgram());
+        if (!program || !program->isValid())
+            continue;
+
+        // LightData holds a single light and this backend has no clustered path, so only
+        // the scene's first light shades the frame, like the OpenGL and D3D12 fallbacks.
+        // It is written once, through the first drawable material
+        if (!lightsApplied) {
+            if (!lights.empty())
+                item.material->applyLight(*lights[0]);
+            lightsApplied = true;
+        }
+
+        // The queue is sorted by program then material, so both change rarely
+        if (program != currentProgram) {
+            applyMaterial(item.material);
+            currentProgram = program;
+            currentMaterial = nullptr;
+        }
+        if (item.material != currentMaterial) {
+            item.material->applyParameters();
+            bindDescriptorSet(program->getPipelineLayout());
+            currentMaterial = item.material;
+        }
+
+        glm::mat4 model = item.object->getTransform().getModelMatrix();
+        vkCmdPushConstants(commandBuffer, program->getPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT,
+                           0, PUSH_CONSTANT_SIZE, &model);
+        draw(*item.mesh);
+    }
+}
+
+unsigned int VulkanRendererBackend::createCubemapTexture(const std::array<TextureImage, 6>& faces) {
     return 0;
 }
 
@@ -849,30 +1063,45 @@ void VulkanRendererBackend::renderSkybox(const Mesh& mesh, unsigned int shaderPr
 }
 
 void VulkanRendererBackend::present(SDL_Window* window) {
-    vkCmdEndRenderPass(commandBuffers[currentImageIndex]);
+    if (!frameActive)
+        return;
+    frameActive = false;
+
+    FrameResources& frame = frames[currentFrame];
+    // The next frame records into the next slot whether or not this one reaches the GPU
+    currentFrame = (currentFrame + 1) % framesInFlight;
 
-    if (vkEndCommandBuffer(commandBuffers[currentImageIndex]) != VK_SUCCESS) {
+    vkCmdEndRenderPass(frame.commandBuffer);
+
+    if (vkEndCommandBuffer(frame.commandBuffer) != VK_SUCCESS) {
         printf("Failed to record command buffer\n");
+        // Deferred deletions handed to this slot rely on its fence following the uploads
+        stagingRing.flush();
+        signalFrameFence(frame);
         return;
     }
 
+    // Uploads recorded since the last frame run first
+    stagingRing.flush();
+
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore waitSemaphores[] = {imageAvailableSemaphore};
+    VkSemaphore waitSemaphores[] = {frame.imageAvailable};
     VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
     submitInfo.waitSemaphoreCount = 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffers[currentImageIndex];
+    submitInfo.pCommandBuffers = &frame.commandBuffer;
 
-    VkSemaphore signalSemaphores[] = {renderFinishedSemaphore};
+    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentImageIndex]};
     submitInfo.signalSemaphoreCount = 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFence) != VK_SUCCESS) {
+    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, frame.inFlight) != VK_SUCCESS) {
         printf("Failed to submit draw command buffer\n");
+        signalFrameFence(frame);
         return;
     }
 
@@ -889,7 +1118,37 @@ void VulkanRendererBackend::present(SDL_Window* window) {
     vkQueuePresentKHR(presentQueue, &presentInfo);
 }
 
-unsigned int VulkanRendererBackend::loadTexture(const std::string& path, uint8_t filterType) {
+void VulkanRendererBackend::signalFrameFence(FrameResources& frame) {
+    // beginFrame reset the fence, so without a signal the slot's next wait never returns.
+    // An empty batch signals it once earlier work completes and consumes imageAvailable
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &frame.imageAvailable;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, frame.inFlight) == VK_SUCCESS)
+        return;
+
+    // The queue rejects work altogether; start the slot over with a signaled fence
+    vkQueueWaitIdle(graphicsQueue);
+    VkFence oldFence = frame.inFlight;
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    if (vkCreateFence(device, &fenceInfo, nullptr, &frame.inFlight) != VK_SUCCESS) {
+        printf("Failed to recreate frame fence\n");
+        frame.inFlight = oldFence;
+        return;
+    }
+    vkDestroyFence(device, oldFence, nullptr);
+    for (auto& imageFence : imagesInFlight) {
+        if (imageFence == oldFence)
+            imageFence = VK_NULL_HANDLE;
+    }
+}
+
+unsigned int VulkanRendererBackend::loadTexture(const TextureImage& image, uint8_t filterType) {
     return 0;
 };
 
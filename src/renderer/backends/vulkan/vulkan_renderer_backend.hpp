@@ -3,6 +3,10 @@
 
 #include "../../../world_object.hpp"
 #include "../../renderer_backend.hpp"
+#include "vulkan_memory_allocator.hpp"
+#include "vulkan_pipeline_compiler.hpp"
+#include "vulkan_staging_ring.hpp"
+#include <glm/glm.hpp>
 #include <vector>
 #include <vulkan/vulkan.h>
 
@@ -20,28 +24,71 @@ class VulkanRendererBackend : public RendererBackend {
     VkRenderPass renderPass = VK_NULL_HANDLE;
     VkCommandPool commandPool = VK_NULL_HANDLE;
     VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    // Seeded from ShaderCacheFile PIPELINE_CACHE_FILE at init, written back at shutdown
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    // Builds programs' pipelines through pipelineCache; stopped before anything is destroyed
+    VulkanPipelineCompiler pipelineCompiler;
+    // Destroyed explicitly before the device; their destructors are then no-ops
+    VulkanMemoryAllocator memoryAllocator;
+    VulkanStagingRing stagingRing;
     VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
-    std::vector<VkDescriptorSet> descriptorSets;
 
     std::vector<VkImage> swapchainImages;
     std::vector<VkImageView> swapchainImageViews;
     std::vector<VkFramebuffer> framebuffers;
-    std::vector<VkCommandBuffer> commandBuffers;
 
     VkImage depthImage = VK_NULL_HANDLE;
     VkDeviceMemory depthImageMemory = VK_NULL_HANDLE;
     VkImageView depthImageView = VK_NULL_HANDLE;
 
-    VkBuffer uniformBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory uniformBufferMemory = VK_NULL_HANDLE;
-    VkBuffer materialBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory materialBufferMemory = VK_NULL_HANDLE;
-    VkBuffer lightDataBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory lightDataBufferMemory = VK_NULL_HANDLE;
+    struct PendingDeletion {
+        VkBuffer buffer;
+        VulkanAllocation allocation;
+    };
 
-    VkSemaphore imageAvailableSemaphore = VK_NULL_HANDLE;
-    VkSemaphore renderFinishedSemaphore = VK_NULL_HANDLE;
-    VkFence inFlightFence = VK_NULL_HANDLE;
+    // Everything one frame in flight records into or reads from, so the CPU can record
+    // frame N+1 while the GPU still executes frame N
+    struct FrameResources {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkSemaphore imageAvailable = VK_NULL_HANDLE;
+        VkFence inFlight = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        // Persistently mapped, host-coherent; laid out as described at uniformBlockOffsets
+        VkBuffer uniformBuffer = VK_NULL_HANDLE;
+        VulkanAllocation uniformAllocation;
+        // MaterialData slots in uniformBuffer; grown by reserveMaterialSlots
+        uint32_t materialSlots = 0;
+        // Freed once this slot's fence signals again
+        std::vector<PendingDeletion> deletions;
+    };
+    std::vector<FrameResources> frames;
+    uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+    uint32_t currentFrame = 0;
+    // Set once beginFrame has acquired an image; recording calls are skipped otherwise
+    bool frameActive = false;
+    // Waited on by the present of each swapchain image. Kept per image rather than per
+    // frame: presentation may still hold one when its frame slot comes around again
+    std::vector<VkSemaphore> renderFinishedSemaphores;
+    // Fence of the frame that last rendered into each swapchain image
+    std::vector<VkFence> imagesInFlight;
+    // Deferred since the last beginFrame; handed to that frame's slot, whose submission
+    // follows every draw and flushed staging copy that could still read them
+    std::vector<PendingDeletion> pendingDeletions;
+
+    // Start of each UniformBlock in a frame's uniform buffer. ModelViewProjection and
+    // LightData hold one copy per frame; MaterialData comes last so its slots, materialStride
+    // apart and bound through a dynamic offset, can grow without moving the other blocks.
+    // Every draw keeps the material parameters it was recorded with
+    VkDeviceSize uniformBlockOffsets[UNIFORM_BLOCK_COUNT] = {};
+    VkDeviceSize materialStride = 0;
+    // Slots of MaterialData written this frame, and the offset of the latest one
+    uint32_t materialWrites = 0;
+    uint32_t materialOffset = 0;
+    // Most slots a frame has asked for; slots that fall short grow to it in beginFrame
+    uint32_t requiredMaterialSlots = DEFAULT_MATERIAL_SLOTS;
+    // Set once this frame's descriptor set is recorded; its buffer is fixed from then on
+    bool descriptorSetBound = false;
+    bool materialOverflowReported = false;
 
     uint32_t graphicsQueueFamily = 0;
     uint32_t presentQueueFamily = 0;
@@ -60,26 +107,56 @@ class VulkanRendererBackend : public RendererBackend {
     bool createFramebuffers();
     bool createCommandPool();
     bool createDepthResources();
-    bool createUniformBuffer();
-    bool createMaterialBuffer();
-    bool createLightDataBuffer();
+    bool createUniformBuffers();
+    bool createFrameUniformBuffer(FrameResources& frame, uint32_t materialSlots);
+    void writeFrameDescriptors(FrameResources& frame);
+    // Makes room for count MaterialData slots in the current frame's uniform buffer; fails
+    // once the descriptor set has been bound this frame
+    bool reserveMaterialSlots(uint32_t count);
     bool createDescriptorPool();
     bool createCommandBuffers();
     bool createSyncObjects();
+    bool createPipelineCache();
+    void savePipelineCache();
+
+    void destroyDeletions(std::vector<PendingDeletion>& deletions);
+    // Signals a frame's fence when present() fails before submitting the frame
+    void signalFrameFence(FrameResources& frame);
 
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+    // Binds the frame's descriptor set at the latest MaterialData slot
+    void bindDescriptorSet(VkPipelineLayout layout);
 
   public:
+    static constexpr const char* PIPELINE_CACHE_FILE = "vk_pipelines.bin";
+    static constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+    static constexpr uint32_t DEFAULT_MATERIAL_SLOTS = 4096;
+    // Per-draw push constants: the model matrix, declared by vertex shaders as
+    // layout(push_constant) uniform Model { mat4 model; }. The model field of the
+    // ModelViewProjection block is left as identity
+    static constexpr uint32_t PUSH_CONSTANT_SIZE = sizeof(glm::mat4);
+    // Sizes of the uniform blocks, indexed by UniformBlock. ClusterLightData is not fed by
+    // this backend and gets neither storage nor a descriptor
+    static constexpr VkDeviceSize UNIFORM_BLOCK_SIZES[UNIFORM_BLOCK_COUNT] = {
+        4 * sizeof(glm::mat4), 4 * sizeof(float), 16 * sizeof(float), 0};
+
     ~VulkanRendererBackend();
 
-    unsigned int loadTexture(const std::string& path, uint8_t filterType = 0) override;
+    // Takes effect at init(); clamped to 1..MAX_FRAMES_IN_FLIGHT
+    void setFramesInFlight(uint32_t count);
+    uint32_t getFramesInFlight() const { return framesInFlight; }
+
+    void beginFrame() override;
+
+    unsigned int loadTexture(const TextureImage& image, uint8_t filterType = 0) override;
     void drawSprite(const Sprite& sprite) override;
     bool init() override;
     bool initWindowContext() override;
-    void bindCamera(Camera* camera) override { return; };
-    void applyMaterial(Material* material) override {};
-    void renderWorldObjects(const std::vector<WorldObject*>& objects,
-                            const std::vector<Light*>& lights) override {};
+    void bindCamera(Camera* camera) override;
+    void applyMaterial(Material* material) override;
+    void renderWorldObjects(const RenderQueue& queue,
+                            const std::vector<Light*>& lights) override;
     void setBufferDataImpl(const std::string& name, const void* data, size_t size) override {};
     void clear(Camera* camera) override;
     void draw(const Mesh&) override;
@@ -89,7 +166,7 @@ class VulkanRendererBackend : public RendererBackend {
     std::string getShaderExtension() const override;
     void renderSkybox(const Mesh& mesh, unsigned int shaderProgram,
                       unsigned int textureID) override;
-    unsigned int createCubemapTexture(const std::vector<std::string>& faces) override;
+    unsigned int createCubemapTexture(const std::array<TextureImage, 6>& faces) override;
     std::unique_ptr<ShaderProgram> createShaderProgram() override;
     std::unique_ptr<ShaderCompiler> createShaderCompiler() override;
     std::unique_ptr<MeshBuffer> createMeshBuffer() override;
@@ -98,12 +175,22 @@ class VulkanRendererBackend : public RendererBackend {
     VkDevice getDevice() const { return device; }
     VkPhysicalDevice getPhysicalDevice() const { return physicalDevice; }
     VkCommandPool getCommandPool() const { return commandPool; }
+    VulkanMemoryAllocator& getMemoryAllocator() { return memoryAllocator; }
+    VulkanStagingRing& getStagingRing() { return stagingRing; }
+    // Destroys the buffer once no submitted or recorded work can read it; clears the handles
+    void deferDestroyBuffer(VkBuffer& buffer, VulkanAllocation& allocation);
     VkInstance getInstance() const { return instance; }
-    VkDeviceMemory getMaterialBufferMemory() const { return materialBufferMemory; }
-    VkDeviceMemory getLightDataBufferMemory() const { return lightDataBufferMemory; }
+    // Command buffer of the frame being recorded
+    VkCommandBuffer getCommandBuffer() const { return frames[currentFrame].commandBuffer; }
+    // Copies a uniform block into the current frame's buffer, at most
+    // UNIFORM_BLOCK_SIZES[block] bytes. MaterialData takes a new slot on every write.
+    // Ignored between frames
+    void writeUniformBlock(UniformBlock block, const void* data, size_t size);
     VkExtent2D getSwapchainExtent() const { return swapchainExtent; }
     VkRenderPass getRenderPass() const { return renderPass; }
     VkDescriptorSetLayout getDescriptorSetLayout() const { return descriptorSetLayout; }
+    VkPipelineCache getPipelineCache() const { return pipelineCache; }
+    VulkanPipelineCompiler& getPipelineCompiler() { return pipelineCompiler; }
     void setSurface(VkSurfaceKHR surf) { surface = surf; }
     void setWindow(SDL_Window* win) { window = win; }
     unsigned int getRequiredWindowFlags() const override;
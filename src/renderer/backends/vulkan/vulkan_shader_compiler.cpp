@@ -9,32 +9,20 @@ bool VulkanShaderCompiler::compile(const std::string& source, ShaderType type, v
     if (!file.is_open()) return false;
     
     size_t fileSize = (size_t)file.tellg();
-    std::vector<char> buffer(fileSize);
+    if (fileSize == 0 || fileSize % sizeof(uint32_t) != 0) return false;
+    
+    auto* code = new VulkanShaderCode();
+    code->words.resize(fileSize / sizeof(uint32_t));
     file.seekg(0);
-    file.read(buffer.data(), fileSize);
+    file.read(reinterpret_cast<char*>(code->words.data()), fileSize);
     file.close();
     
-    VkShaderModuleCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = buffer.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(buffer.data());
-    
-    VkShaderModule* shaderModule = new VkShaderModule();
-    if (vkCreateShaderModule(backend->getDevice(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
-        delete shaderModule;
-        return false;
-    }
-    
-    *outHandle = shaderModule;
+    *outHandle = code;
     return true;
 }
 
 void VulkanShaderCompiler::destroy(void* handle) {
-    if (handle) {
-        VkShaderModule* module = static_cast<VkShaderModule*>(handle);
-        vkDestroyShaderModule(backend->getDevice(), *module, nullptr);
-        delete module;
-    }
+    delete static_cast<VulkanShaderCode*>(handle);
 }
 
 bool VulkanShaderCompiler::isValid(void* handle) {
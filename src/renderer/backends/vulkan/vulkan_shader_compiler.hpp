@@ -2,10 +2,18 @@
 #define VULKAN_SHADER_COMPILER_HPP
 
 #include "../../../shader_compiler.hpp"
+#include <cstdint>
+#include <vector>
 #include <vulkan/vulkan.h>
 
 class VulkanRendererBackend;
 
+// Handle returned by VulkanShaderCompiler. Modules are created by the pipeline worker that
+// builds the program, so the shader asset can be released as soon as the program is linked
+struct VulkanShaderCode {
+    std::vector<uint32_t> words;
+};
+
 class VulkanShaderCompiler : public ShaderCompiler {
 private:
     VulkanRendererBackend* backend;
@@ -1,10 +1,17 @@
 #include "vulkan_shader_program.hpp"
+#define CLASS_NAME "VulkanShaderProgram"
 #include "vulkan_renderer_backend.hpp"
+#include "vulkan_shader_compiler.hpp"
+#include "../../../log_macros.hpp"
 #include "../../../shader_asset.hpp"
+#include <algorithm>
 #include <cstring>
 #include <array>
+#include <chrono>
 
 VulkanShaderProgram::~VulkanShaderProgram() {
+    if (pendingBuild.valid())
+        pendingBuild.wait();
     if (pipeline) {
         vkDestroyPipeline(backend->getDevice(), pipeline, nullptr);
     }
@@ -14,17 +21,53 @@ VulkanShaderProgram::~VulkanShaderProgram() {
 }
 
 bool VulkanShaderProgram::attachShader(const ShaderAsset& shader) {
-    VkShaderModule module = *static_cast<VkShaderModule*>(shader.getHandle());
-    shaderModules.push_back(module);
+    auto* code = static_cast<const VulkanShaderCode*>(shader.getHandle());
+    if (!code)
+        return false;
+    shaderCode.push_back(code->words);
     shaderTypes.push_back(shader.getType());
     return true;
 }
 
 bool VulkanShaderProgram::link() {
-    return createPipeline();
+    // Returns at once; the program is skipped by the renderer until isReady()
+    pendingBuild = backend->getPipelineCompiler().submit([this] { return createPipeline(); });
+    return true;
+}
+
+bool VulkanShaderProgram::isReady() {
+    if (pendingBuild.valid() &&
+        pendingBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        ready = pendingBuild.get();
+        if (!ready)
+            LOG_ERROR("Failed to build pipeline");
+    }
+    return ready;
 }
 
 bool VulkanShaderProgram::createPipeline() {
+    VkDevice device = backend->getDevice();
+    std::vector<VkShaderModule> shaderModules;
+    auto destroyModules = [&]() {
+        for (VkShaderModule module : shaderModules)
+            vkDestroyShaderModule(device, module, nullptr);
+        shaderCode.clear();
+    };
+    
+    for (const auto& words : shaderCode) {
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = words.size() * sizeof(uint32_t);
+        createInfo.pCode = words.data();
+        
+        VkShaderModule module;
+        if (vkCreateShaderModule(device, &createInfo, nullptr, &module) != VK_SUCCESS) {
+            destroyModules();
+            return false;
+        }
+        shaderModules.push_back(module);
+    }
+    
     std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
     
     for (size_t i = 0; i < shaderModules.size(); i++) {
@@ -42,31 +85,36 @@ bool VulkanShaderProgram::createPipeline() {
         shaderStages.push_back(stageInfo);
     }
     
-    VkVertexInputBindingDescription bindingDescriptions[2] = {};
-    bindingDescriptions[0].binding = 0;
-    bindingDescriptions[0].stride = 3 * sizeof(float);
-    bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-    
-    bindingDescriptions[1].binding = 1;
-    bindingDescriptions[1].stride = 3 * sizeof(float);
-    bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-    
-    VkVertexInputAttributeDescription attributeDescriptions[2] = {};
-    attributeDescriptions[0].binding = 0;
-    attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[0].offset = 0;
-    
-    attributeDescriptions[1].binding = 1;
-    attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[1].offset = 0;
+    // A single interleaved binding, described by the mesh layout
+    VkVertexInputBindingDescription bindingDescription{};
+    bindingDescription.binding = 0;
+    bindingDescription.stride = vertexLayout.stride;
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    
+    VkVertexInputAttributeDescription attributeDescriptions[VertexLayout::MAX_ATTRIBUTES] = {};
+    for (uint32_t i = 0; i < vertexLayout.attributeCount; i++) {
+        const auto& attribute = vertexLayout.attributes[i];
+        attributeDescriptions[i].binding = 0;
+        attributeDescriptions[i].location = attribute.location;
+        attributeDescriptions[i].offset = attribute.offset;
+        switch (attribute.format) {
+        case VertexFormat::FLOAT2:
+            attributeDescriptions[i].format = VK_FORMAT_R32G32_SFLOAT;
+            break;
+        case VertexFormat::FLOAT3:
+            attributeDescriptions[i].format = VK_FORMAT_R32G32B32_SFLOAT;
+            break;
+        case VertexFormat::FLOAT4:
+            attributeDescriptions[i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+            break;
+        }
+    }
     
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 2;
-    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions;
-    vertexInputInfo.vertexAttributeDescriptionCount = 2;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexAttributeDescriptionCount = vertexLayout.attributeCount;
     vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions;
     
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
@@ -133,8 +181,17 @@ bool VulkanShaderProgram::createPipeline() {
     pipelineLayoutInfo.setLayoutCount = 1;
     auto descriptorSetLayout = backend->getDescriptorSetLayout();
     pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-    
-    if (vkCreatePipelineLayout(backend->getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+    // Identical in every program, so the descriptor set survives pipeline switches
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = VulkanRendererBackend::PUSH_CONSTANT_SIZE;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) !=
+        VK_SUCCESS) {
+        destroyModules();
         return false;
     }
     
@@ -153,29 +210,23 @@ bool VulkanShaderProgram::createPipeline() {
     pipelineInfo.renderPass = backend->getRenderPass();
     pipelineInfo.subpass = 0;
     
-    return vkCreateGraphicsPipelines(backend->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) == VK_SUCCESS;
+    VkResult result = vkCreateGraphicsPipelines(device, backend->getPipelineCache(), 1,
+                                                &pipelineInfo, nullptr, &pipeline);
+    // Pipelines keep no reference to their modules
+    destroyModules();
+    return result == VK_SUCCESS;
 }
 
 void VulkanShaderProgram::use() {
     // Em Vulkan, "use" é feito via vkCmdBindPipeline no command buffer
 }
 
-void VulkanShaderProgram::setUniformBuffer(const char* name, const void* data, size_t size) {
+void VulkanShaderProgram::setUniformBuffer(UniformBlock block, const void* data, size_t size) {
+    if (!backend)
+        return;
 
-    //temporary fix
-    int binding = 0;
-
-    if (binding == 1 && backend) {
-        void* mapped;
-        vkMapMemory(backend->getDevice(), backend->getMaterialBufferMemory(), 0, size, 0, &mapped);
-        memcpy(mapped, data, size);
-        vkUnmapMemory(backend->getDevice(), backend->getMaterialBufferMemory());
-    } else if (binding == 2 && backend) {
-        void* mapped;
-        vkMapMemory(backend->getDevice(), backend->getLightDataBufferMemory(), 0, size, 0, &mapped);
-        memcpy(mapped, data, size);
-        vkUnmapMemory(backend->getDevice(), backend->getLightDataBufferMemory());
-    }
+    // Written into the current frame's buffer, which the GPU is no longer reading
+    backend->writeUniformBlock(block, data, size);
 }
 
 void* VulkanShaderProgram::getHandle() const {
@@ -183,5 +234,5 @@ void* VulkanShaderProgram::getHandle() const {
 }
 
 bool VulkanShaderProgram::isValid() const {
-    return pipeline != VK_NULL_HANDLE;
+    return ready && pipeline != VK_NULL_HANDLE;
 }
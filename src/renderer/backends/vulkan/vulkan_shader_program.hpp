@@ -4,6 +4,8 @@
 #include "../../../shader_program.hpp"
 #include "../../../shader_type.hpp"
 #include "material.hpp"
+#include <cstdint>
+#include <future>
 #include <vulkan/vulkan.h>
 #include <vector>
 
@@ -12,11 +14,16 @@ class VulkanRendererBackend;
 class VulkanShaderProgram : public ShaderProgram {
 private:
     VulkanRendererBackend* backend;
-    std::vector<VkShaderModule> shaderModules;
+    // SPIR-V of the attached shaders, released once the pipeline is built
+    std::vector<std::vector<uint32_t>> shaderCode;
     std::vector<ShaderType> shaderTypes;
+    // Written by the pipeline worker; read only after isReady() returned true
     VkPipeline pipeline = VK_NULL_HANDLE;
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    std::future<bool> pendingBuild;
+    bool ready = false;
     
+    // Runs on a VulkanPipelineCompiler worker
     bool createPipeline();
     
 public:
@@ -26,9 +33,10 @@ public:
     bool attachShader(const ShaderAsset& shader) override;
     bool link() override;
     void use() override;
-    void setUniformBuffer(const char* name, const void* data, size_t size) override;
+    void setUniformBuffer(UniformBlock block, const void* data, size_t size) override;
     void* getHandle() const override;
     bool isValid() const override;
+    bool isReady() override;
     
     VkPipeline getPipeline() const { return pipeline; }
     VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
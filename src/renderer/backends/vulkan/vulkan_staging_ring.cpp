@@ -0,0 +1,153 @@
+#define CLASS_NAME "VulkanStagingRing"
+#include "log_macros.hpp"
+
+#include "vulkan_staging_ring.hpp"
+#include <algorithm>
+#include <cstring>
+
+VulkanStagingRing::~VulkanStagingRing() { destroy(); }
+
+bool VulkanStagingRing::init(VkDevice device, VkQueue queue, VkCommandPool commandPool,
+                             VulkanMemoryAllocator& allocator) {
+    destroy();
+    this->device = device;
+    this->queue = queue;
+    this->commandPool = commandPool;
+    this->allocator = &allocator;
+
+    if (!allocator.createBuffer(RING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                buffer, allocation)) {
+        LOG_ERROR("Failed to create the staging ring buffer");
+        return false;
+    }
+    head = 0;
+    return true;
+}
+
+void VulkanStagingRing::destroy() {
+    if (!allocator)
+        return;
+
+    flush();
+    drain();
+    allocator->destroyBuffer(buffer, allocation);
+    allocator = nullptr;
+}
+
+bool VulkanStagingRing::beginCommandBuffer() {
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+    if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        commandBuffer = VK_NULL_HANDLE;
+        return false;
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    return true;
+}
+
+bool VulkanStagingRing::upload(VkBuffer dst, VkDeviceSize dstOffset, const void* data,
+                               VkDeviceSize size) {
+    if (!allocator || !buffer)
+        return false;
+
+    // Uploads larger than the ring go through in ring-sized pieces
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        // Copies only need 4-byte aligned source offsets
+        VkDeviceSize offset = (head + 3) & ~VkDeviceSize(3);
+        if (offset >= RING_SIZE) {
+            flush();
+            drain();
+            offset = 0;
+        }
+        VkDeviceSize chunk = std::min(size, RING_SIZE - offset);
+        if (chunk < size && offset > 0) {
+            // Start over at the front rather than splitting a copy that would fit there
+            flush();
+            drain();
+            offset = 0;
+            chunk = std::min(size, RING_SIZE);
+        }
+
+        if (!commandBuffer && !beginCommandBuffer()) {
+            LOG_ERROR("Failed to allocate a staging command buffer");
+            return false;
+        }
+
+        std::memcpy(allocation.mapped + offset, bytes, chunk);
+        VkBufferCopy region{};
+        region.srcOffset = offset;
+        region.dstOffset = dstOffset;
+        region.size = chunk;
+        vkCmdCopyBuffer(commandBuffer, buffer, dst, 1, &region);
+
+        head = offset + chunk;
+        bytes += chunk;
+        dstOffset += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+void VulkanStagingRing::flush() {
+    if (!commandBuffer)
+        return;
+
+    // Covers every read of the copied data by any later submission on the queue
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                            VK_ACCESS_UNIFORM_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+    vkEndCommandBuffer(commandBuffer);
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence = VK_NULL_HANDLE;
+    vkCreateFence(device, &fenceInfo, nullptr, &fence);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS) {
+        LOG_ERROR("Failed to submit staged uploads");
+        vkDestroyFence(device, fence, nullptr);
+        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+        commandBuffer = VK_NULL_HANDLE;
+        return;
+    }
+
+    inFlight.push_back(Submission{commandBuffer, fence});
+    commandBuffer = VK_NULL_HANDLE;
+}
+
+void VulkanStagingRing::retire() {
+    while (!inFlight.empty() && vkGetFenceStatus(device, inFlight.front().fence) == VK_SUCCESS) {
+        vkDestroyFence(device, inFlight.front().fence, nullptr);
+        vkFreeCommandBuffers(device, commandPool, 1, &inFlight.front().commandBuffer);
+        inFlight.pop_front();
+    }
+    // Nothing left reading the ring
+    if (inFlight.empty() && !commandBuffer)
+        head = 0;
+}
+
+void VulkanStagingRing::drain() {
+    for (auto& submission : inFlight)
+        vkWaitForFences(device, 1, &submission.fence, VK_TRUE, UINT64_MAX);
+    retire();
+}
@@ -0,0 +1,60 @@
+#ifndef VULKAN_STAGING_RING_HPP
+#define VULKAN_STAGING_RING_HPP
+
+#include "vulkan_memory_allocator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vulkan/vulkan.h>
+
+// Uploads data into DEVICE_LOCAL buffers through a host-visible ring. upload() copies the
+// data into the ring and records a vkCmdCopyBuffer; flush() submits everything recorded
+// since the last flush on the graphics queue, ending with a barrier that makes the copies
+// visible to vertex input, index and uniform reads of later submissions.
+//
+// The ring is consumed linearly. Space comes back once the fences of the submissions that
+// read it have signaled; running off the end flushes and drains the ring before wrapping,
+// which only happens during large loads.
+class VulkanStagingRing {
+  private:
+    static constexpr VkDeviceSize RING_SIZE = 16ull * 1024 * 1024;
+
+    struct Submission {
+        VkCommandBuffer commandBuffer;
+        VkFence fence;
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VulkanMemoryAllocator* allocator = nullptr;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VulkanAllocation allocation;
+    VkDeviceSize head = 0;
+    // Recording, not yet submitted
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    std::deque<Submission> inFlight;
+
+    bool beginCommandBuffer();
+    // Waits for every submission, after which the whole ring is free
+    void drain();
+
+  public:
+    VulkanStagingRing() = default;
+    VulkanStagingRing(const VulkanStagingRing&) = delete;
+    VulkanStagingRing& operator=(const VulkanStagingRing&) = delete;
+    ~VulkanStagingRing();
+
+    bool init(VkDevice device, VkQueue queue, VkCommandPool commandPool,
+              VulkanMemoryAllocator& allocator);
+    void destroy();
+
+    // Queues a copy of size bytes into dst at dstOffset; data may be released on return
+    bool upload(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+    // Submits the queued copies; call before submitting work that reads them
+    void flush();
+    // Recycles the submissions the GPU has finished, without blocking
+    void retire();
+};
+
+#endif // VULKAN_STAGING_RING_HPP
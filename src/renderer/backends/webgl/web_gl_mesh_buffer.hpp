@@ -7,13 +7,13 @@
 class WebGLMeshBuffer : public MeshBuffer {
 private:
     GLuint VAO = 0;
-    GLuint positionVBO = 0;
-    GLuint normalVBO = 0;
+    GLuint vertexVBO = 0;
+    GLuint indexEBO = 0;
 
 public:
     ~WebGLMeshBuffer() override;
     
-    bool createBuffers(const std::vector<float>& vertices, const std::vector<float>& normals) override;
+    bool createBuffers(const MeshBufferDesc& desc) override;
     void bind() override;
     void unbind() override;
     void destroy() override;
@@ -3,12 +3,13 @@
 #include "graphics_api.hpp"
 #include <GL/glew.h>
 #include <SDL2/SDL.h>
+#include <cstdio>
 #include <emscripten.h>
+#include <emscripten/html5.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#include "stb_image.h"
 
 GraphicsAPI WebGLRendererBackend::getGraphicsAPI() const { return GraphicsAPI::WEBGL; }
 
@@ -27,6 +28,11 @@ void WebGLRendererBackend::onCameraSet() {
 bool WebGLRendererBackend::init() {
     glEnable(GL_DEPTH_TEST);
 
+    // WebGL extensions stay unusable until enabled; desktop browsers generally expose S3TC,
+    // most mobile ones do not
+    s3tcSupported = emscripten_webgl_enable_extension(emscripten_webgl_get_current_context(),
+                                                      "WEBGL_compressed_texture_s3tc");
+
     glGenBuffers(1, &matricesUBO);
     glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
     glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4) * 3, nullptr, GL_DYNAMIC_DRAW);
@@ -51,7 +57,13 @@ void WebGLRendererBackend::draw(const Mesh& mesh) {
 
     auto vao = static_cast<GLuint>(reinterpret_cast<uintptr_t>(mesh.getMeshBufferHandle()));
     glBindVertexArray(vao);
-    glDrawArrays(GL_TRIANGLES, 0, mesh.getVertices().size() / 3);
+    if (mesh.isIndexed()) {
+        GLenum indexType =
+            mesh.getIndexType() == IndexType::UINT16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        glDrawElements(GL_TRIANGLES, mesh.getIndexCount(), indexType, nullptr);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, mesh.getVertexCount());
+    }
     glBindVertexArray(0);
 }
 
@@ -87,28 +99,41 @@ void WebGLRendererBackend::setUniforms(unsigned int shaderProgram) {
     
 }
 
-unsigned int WebGLRendererBackend::createCubemapTexture(const std::vector<std::string>& faces) {
+unsigned int WebGLRendererBackend::createCubemapTexture(const std::array<TextureImage, 6>& faces) {
     unsigned int textureID;
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
-    int width, height, nrChannels;
     for (unsigned int i = 0; i < faces.size(); i++) {
-        unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-
-        if (data) {
-            GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format,
-                         GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        } else {
-            //printf("Cubemap texture failed to load at path: %s\n", faces[i].c_str());
-            stbi_image_free(data);
+        const auto& face = faces[i];
+        GLenum compressedFormat = 0;
+        if (face.format == TextureFormat::BC1)
+            compressedFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        else if (face.format == TextureFormat::BC3)
+            compressedFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+        if (compressedFormat != 0 && !s3tcSupported) {
+            printf("Cubemap face #%u is S3TC compressed, but WEBGL_compressed_texture_s3tc is "
+                   "not available\n",
+                   i);
+            glDeleteTextures(1, &textureID);
             return 0;
         }
+
+        for (uint32_t level = 0; level < face.levelCount; level++) {
+            const auto& data = face.levels[level];
+            if (compressedFormat != 0)
+                glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, level, compressedFormat,
+                                       data.width, data.height, 0, data.size, data.data);
+            else
+                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, level, GL_RGBA, data.width,
+                             data.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data);
+        }
     }
 
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, faces[0].levelCount - 1);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER,
+                    faces[0].levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
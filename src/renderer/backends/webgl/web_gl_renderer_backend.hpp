@@ -11,6 +11,8 @@
 class WebGLRendererBackend : public RendererBackend {
 private: 
     GLuint matricesUBO = 0;
+    // WEBGL_compressed_texture_s3tc, required for BC1/BC3 textures
+    bool s3tcSupported = false;
 
 public:
     ~WebGLRendererBackend();
@@ -22,7 +24,7 @@ public:
     void onCameraSet() override;
 
     // Skybox management
-    unsigned int createCubemapTexture(const std::vector<std::string>& faces) override;
+    unsigned int createCubemapTexture(const std::array<TextureImage, 6>& faces) override;
     GraphicsAPI getGraphicsAPI() const override;
     void deleteCubemapTexture(unsigned int textureID);
     void renderSkybox(const Mesh& mesh, unsigned int shaderProgram, unsigned int textureID) override;
@@ -0,0 +1,119 @@
+#include "frustum_culler.hpp"
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_CULLER_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_CULLER_WIDTH 4
+#else
+#define FRUSTUM_CULLER_WIDTH 1
+#endif
+
+namespace {
+struct Plane {
+    float x, y, z, w;
+};
+
+// Gribb/Hartmann: left, right, bottom, top, near, far
+void extractPlanes(const glm::mat4& m, Plane planes[6]) {
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+    glm::vec4 rows[6] = {row3 + row0, row3 - row0, row3 + row1,
+                         row3 - row1, row3 + row2, row3 - row2};
+    for (int i = 0; i < 6; i++)
+        planes[i] = Plane{rows[i].x, rows[i].y, rows[i].z, rows[i].w};
+}
+} // namespace
+
+uint32_t FrustumCuller::add(const Bounds& localBounds, const glm::mat4& model) {
+    // Transform center and extents instead of the eight corners
+    glm::vec3 center((localBounds.min.x + localBounds.max.x) * 0.5f,
+                     (localBounds.min.y + localBounds.max.y) * 0.5f,
+                     (localBounds.min.z + localBounds.max.z) * 0.5f);
+    glm::vec3 extent((localBounds.max.x - localBounds.min.x) * 0.5f,
+                     (localBounds.max.y - localBounds.min.y) * 0.5f,
+                     (localBounds.max.z - localBounds.min.z) * 0.5f);
+
+    glm::vec3 worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+    glm::vec3 worldExtent;
+    for (int row = 0; row < 3; row++) {
+        worldExtent[row] = std::fabs(model[0][row]) * extent.x +
+                           std::fabs(model[1][row]) * extent.y +
+                           std::fabs(model[2][row]) * extent.z;
+    }
+
+    // Keep the arrays padded to a whole SIMD block
+    size_t capacity = (count / FRUSTUM_CULLER_WIDTH + 1) * FRUSTUM_CULLER_WIDTH;
+    if (minX.size() < capacity) {
+        for (auto* array : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ})
+            array->resize(capacity, 0.0f);
+    }
+
+    minX[count] = worldCenter.x - worldExtent.x;
+    minY[count] = worldCenter.y - worldExtent.y;
+    minZ[count] = worldCenter.z - worldExtent.z;
+    maxX[count] = worldCenter.x + worldExtent.x;
+    maxY[count] = worldCenter.y + worldExtent.y;
+    maxZ[count] = worldCenter.z + worldExtent.z;
+    return static_cast<uint32_t>(count++);
+}
+
+void FrustumCuller::cull(const glm::mat4& viewProjection, std::vector<uint32_t>& visible) {
+    Plane planes[6];
+    extractPlanes(viewProjection, planes);
+
+    // A box is outside when its corner furthest along the plane normal is behind the plane.
+    // The normal is the same for every lane, so picking min or max per axis is a scalar choice.
+    size_t blocks = (count + FRUSTUM_CULLER_WIDTH - 1) / FRUSTUM_CULLER_WIDTH;
+    for (size_t block = 0; block < blocks; block++) {
+        size_t base = block * FRUSTUM_CULLER_WIDTH;
+#if FRUSTUM_CULLER_WIDTH == 8
+        __m256 outside = _mm256_setzero_ps();
+        for (const auto& plane : planes) {
+            __m256 x = _mm256_loadu_ps(plane.x >= 0.0f ? &maxX[base] : &minX[base]);
+            __m256 y = _mm256_loadu_ps(plane.y >= 0.0f ? &maxY[base] : &minY[base]);
+            __m256 z = _mm256_loadu_ps(plane.z >= 0.0f ? &maxZ[base] : &minZ[base]);
+            __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane.x)),
+                              _mm256_mul_ps(y, _mm256_set1_ps(plane.y))),
+                _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(plane.z)),
+                              _mm256_set1_ps(plane.w)));
+            outside = _mm256_or_ps(outside,
+                                   _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+        uint32_t visibleMask = ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xFF;
+#elif FRUSTUM_CULLER_WIDTH == 4
+        __m128 outside = _mm_setzero_ps();
+        for (const auto& plane : planes) {
+            __m128 x = _mm_loadu_ps(plane.x >= 0.0f ? &maxX[base] : &minX[base]);
+            __m128 y = _mm_loadu_ps(plane.y >= 0.0f ? &maxY[base] : &minY[base]);
+            __m128 z = _mm_loadu_ps(plane.z >= 0.0f ? &maxZ[base] : &minZ[base]);
+            __m128 distance =
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)),
+                                      _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+                           _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+        }
+        uint32_t visibleMask = ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xF;
+#else
+        uint32_t visibleMask = 1;
+        for (const auto& plane : planes) {
+            float x = plane.x >= 0.0f ? maxX[base] : minX[base];
+            float y = plane.y >= 0.0f ? maxY[base] : minY[base];
+            float z = plane.z >= 0.0f ? maxZ[base] : minZ[base];
+            if (x * plane.x + y * plane.y + z * plane.z + plane.w < 0.0f) {
+                visibleMask = 0;
+                break;
+            }
+        }
+#endif
+        for (uint32_t lane = 0; lane < FRUSTUM_CULLER_WIDTH; lane++) {
+            if ((visibleMask & (1u << lane)) && base + lane < count)
+                visible.push_back(static_cast<uint32_t>(base + lane));
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef FRUSTUM_CULLER_HPP
+#define FRUSTUM_CULLER_HPP
+
+#include "../mesh.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// World-space AABBs kept as structure-of-arrays so the test runs 8 (AVX), 4 (SSE) or 1
+// (scalar fallback, e.g. WebAssembly) boxes at a time against the six frustum planes
+class FrustumCuller {
+  private:
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+    size_t count = 0;
+
+  public:
+    void clear() { count = 0; }
+    // Transforms the local bounds by model and appends them; returns the box index
+    uint32_t add(const Bounds& localBounds, const glm::mat4& model);
+    size_t size() const { return count; }
+
+    // Appends the indices of the boxes intersecting the frustum of viewProjection (OpenGL
+    // clip conventions) to visible, in increasing order
+    void cull(const glm::mat4& viewProjection, std::vector<uint32_t>& visible);
+};
+
+#endif
@@ -0,0 +1,245 @@
+#define CLASS_NAME "LightClusterGrid"
+#include "../log_macros.hpp"
+
+#include "../world_object.hpp"
+#include "light_clusters.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define LIGHT_CLUSTERS_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LIGHT_CLUSTERS_WIDTH 4
+#else
+#define LIGHT_CLUSTERS_WIDTH 1
+#endif
+
+static_assert(LightClusterGrid::TILES_PER_SLICE % LIGHT_CLUSTERS_WIDTH == 0,
+              "A slice must be a whole number of SIMD blocks");
+static_assert(sizeof(ClusterLightingHeader) == 48, "Must match the std140 ClusterLightData header");
+static_assert(sizeof(ClusterLight) == 64, "Must match the std140 light record");
+
+LightClusterGrid::LightClusterGrid() {
+    for (auto* array : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ})
+        array->resize(CLUSTER_COUNT, 0.0f);
+    clusters.resize(CLUSTER_COUNT, ClusterRecord{0, 0});
+}
+
+float LightClusterGrid::sliceDepth(uint32_t slice) const {
+    const auto& header = block.header;
+    float t = static_cast<float>(slice) / GRID_Z;
+    if (header.logDepth)
+        return header.nearDistance * std::pow(header.farDistance / header.nearDistance, t);
+    return header.nearDistance + (header.farDistance - header.nearDistance) * t;
+}
+
+int32_t LightClusterGrid::sliceOf(float depth) const {
+    const auto& header = block.header;
+    if (header.logDepth)
+        depth = std::log(std::max(depth, header.nearDistance));
+    return static_cast<int32_t>(std::floor(depth * header.sliceScale + header.sliceBias));
+}
+
+void LightClusterGrid::buildClusterBounds(const glm::mat4& projection) {
+    const glm::mat4 inverseProjection = glm::inverse(projection);
+    auto unproject = [&](float x, float y, float z) {
+        glm::vec4 p = inverseProjection * glm::vec4(x, y, z, 1.0f);
+        return glm::vec3(p) / p.w;
+    };
+
+    for (uint32_t slice = 0; slice < GRID_Z; slice++) {
+        float depths[2] = {sliceDepth(slice), sliceDepth(slice + 1)};
+        for (uint32_t tileY = 0; tileY < GRID_Y; tileY++) {
+            for (uint32_t tileX = 0; tileX < GRID_X; tileX++) {
+                glm::vec3 lo(INFINITY), hi(-INFINITY);
+                // The four edges of the tile, cut at both slice depths
+                for (uint32_t corner = 0; corner < 4; corner++) {
+                    float x = -1.0f + 2.0f * static_cast<float>(tileX + (corner & 1)) / GRID_X;
+                    float y = -1.0f + 2.0f * static_cast<float>(tileY + (corner >> 1)) / GRID_Y;
+                    glm::vec3 nearPoint = unproject(x, y, -1.0f);
+                    glm::vec3 farPoint = unproject(x, y, 1.0f);
+                    for (float depth : depths) {
+                        // View space looks down -z
+                        float t = (depth + nearPoint.z) / (nearPoint.z - farPoint.z);
+                        glm::vec3 p = nearPoint + (farPoint - nearPoint) * t;
+                        lo = glm::min(lo, p);
+                        hi = glm::max(hi, p);
+                    }
+                }
+
+                uint32_t index = slice * TILES_PER_SLICE + tileY * GRID_X + tileX;
+                minX[index] = lo.x;
+                minY[index] = lo.y;
+                minZ[index] = lo.z;
+                maxX[index] = hi.x;
+                maxY[index] = hi.y;
+                maxZ[index] = hi.z;
+            }
+        }
+    }
+    cachedProjection = projection;
+}
+
+void LightClusterGrid::assignLight(uint16_t lightIndex, const glm::vec3& center, float radius) {
+    float depth = -center.z;
+    if (depth + radius < block.header.nearDistance || depth - radius > block.header.farDistance)
+        return;
+
+    uint32_t firstSlice = static_cast<uint32_t>(std::clamp<int32_t>(
+        sliceOf(depth - radius), 0, static_cast<int32_t>(GRID_Z) - 1));
+    uint32_t lastSlice = static_cast<uint32_t>(std::clamp<int32_t>(
+        sliceOf(depth + radius), 0, static_cast<int32_t>(GRID_Z) - 1));
+    float radiusSquared = radius * radius;
+
+    // Sphere vs AABB: squared distance from the center to the box, per axis the overshoot
+    // past whichever face it is outside of
+    for (uint32_t slice = firstSlice; slice <= lastSlice; slice++) {
+        for (uint32_t tile = 0; tile < TILES_PER_SLICE; tile += LIGHT_CLUSTERS_WIDTH) {
+            uint32_t base = slice * TILES_PER_SLICE + tile;
+#if LIGHT_CLUSTERS_WIDTH == 8
+            __m256 distance = _mm256_setzero_ps();
+            const float* mins[3] = {&minX[base], &minY[base], &minZ[base]};
+            const float* maxs[3] = {&maxX[base], &maxY[base], &maxZ[base]};
+            for (int axis = 0; axis < 3; axis++) {
+                __m256 c = _mm256_set1_ps(center[axis]);
+                __m256 below = _mm256_max_ps(_mm256_sub_ps(_mm256_loadu_ps(mins[axis]), c),
+                                             _mm256_setzero_ps());
+                __m256 above = _mm256_max_ps(_mm256_sub_ps(c, _mm256_loadu_ps(maxs[axis])),
+                                             _mm256_setzero_ps());
+                __m256 d = _mm256_add_ps(below, above);
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(d, d));
+            }
+            uint32_t hitMask = static_cast<uint32_t>(_mm256_movemask_ps(
+                _mm256_cmp_ps(distance, _mm256_set1_ps(radiusSquared), _CMP_LE_OQ)));
+#elif LIGHT_CLUSTERS_WIDTH == 4
+            __m128 distance = _mm_setzero_ps();
+            const float* mins[3] = {&minX[base], &minY[base], &minZ[base]};
+            const float* maxs[3] = {&maxX[base], &maxY[base], &maxZ[base]};
+            for (int axis = 0; axis < 3; axis++) {
+                __m128 c = _mm_set1_ps(center[axis]);
+                __m128 below =
+                    _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(mins[axis]), c), _mm_setzero_ps());
+                __m128 above =
+                    _mm_max_ps(_mm_sub_ps(c, _mm_loadu_ps(maxs[axis])), _mm_setzero_ps());
+                __m128 d = _mm_add_ps(below, above);
+                distance = _mm_add_ps(distance, _mm_mul_ps(d, d));
+            }
+            uint32_t hitMask = static_cast<uint32_t>(
+                _mm_movemask_ps(_mm_cmple_ps(distance, _mm_set1_ps(radiusSquared))));
+#else
+            float distance = 0.0f;
+            const float lo[3] = {minX[base], minY[base], minZ[base]};
+            const float hi[3] = {maxX[base], maxY[base], maxZ[base]};
+            for (int axis = 0; axis < 3; axis++) {
+                float d = std::max(lo[axis] - center[axis], 0.0f) +
+                          std::max(center[axis] - hi[axis], 0.0f);
+                distance += d * d;
+            }
+            uint32_t hitMask = distance <= radiusSquared ? 1 : 0;
+#endif
+            for (uint32_t lane = 0; lane < LIGHT_CLUSTERS_WIDTH; lane++) {
+                if (hitMask & (1u << lane)) {
+                    hitClusters.push_back(base + lane);
+                    hitLights.push_back(lightIndex);
+                }
+            }
+        }
+    }
+}
+
+void LightClusterGrid::build(const std::vector<Light*>& lights, const glm::mat4& view,
+                             const glm::mat4& projection, bool orthographic, float nearDistance,
+                             float farDistance, float screenWidth, float screenHeight) {
+    auto& header = block.header;
+    header.grid[0] = GRID_X;
+    header.grid[1] = GRID_Y;
+    header.grid[2] = GRID_Z;
+    header.logDepth = orthographic ? 0 : 1;
+    header.screenSize[0] = screenWidth;
+    header.screenSize[1] = screenHeight;
+    header.nearDistance = nearDistance;
+    header.farDistance = farDistance;
+    const float sliceCount = static_cast<float>(GRID_Z);
+    if (orthographic) {
+        header.sliceScale = sliceCount / (farDistance - nearDistance);
+        header.sliceBias = -nearDistance * header.sliceScale;
+    } else {
+        float logRatio = std::log(farDistance / nearDistance);
+        header.sliceScale = sliceCount / logRatio;
+        header.sliceBias = -std::log(nearDistance) * header.sliceScale;
+    }
+    if (projection != cachedProjection)
+        buildClusterBounds(projection);
+
+    // Directional lights first, so shaders can apply them without a cluster lookup
+    uint32_t count = 0;
+    uint32_t dropped = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (const Light* light : lights) {
+            bool directional = light->getType() == LightType::DIRECTIONAL;
+            if (directional != (pass == 0) || (!directional && !light->getOwner()))
+                continue;
+            if (count == MAX_CLUSTER_LIGHTS) {
+                dropped++;
+                continue;
+            }
+
+            const Vector3& direction = light->getDirection();
+            const ColorRGBA& color = light->getColor();
+            ClusterLight& record = block.lights[count++];
+            record.positionRange = glm::vec4(0.0f, 0.0f, 0.0f, light->getRange());
+            if (!directional) {
+                Vector3 position = light->getOwner()->getTransform().getPosition();
+                record.positionRange = glm::vec4(position.x, position.y, position.z,
+                                                 light->getRange());
+            }
+            glm::vec3 axis = glm::vec3(direction.x, direction.y, direction.z);
+            if (glm::dot(axis, axis) > 0.0f)
+                axis = glm::normalize(axis);
+            record.directionType = glm::vec4(axis, static_cast<float>(light->getType()));
+            record.colorIntensity = glm::vec4(color.r, color.g, color.b, light->getIntensity());
+
+            float cosInner = std::cos(glm::radians(light->getInnerConeAngle()));
+            float cosOuter = std::cos(glm::radians(light->getOuterConeAngle()));
+            float scale = 1.0f / std::max(cosInner - cosOuter, 1e-4f);
+            record.spotScaleOffset = glm::vec4(scale, -cosOuter * scale, 0.0f, 0.0f);
+        }
+        if (pass == 0)
+            header.grid[3] = count;
+    }
+    header.lightCount = count;
+
+    if (dropped > 0 && !overflowReported) {
+        LOG_WARN(std::to_string(dropped) + " lights over the limit of " +
+                 std::to_string(MAX_CLUSTER_LIGHTS) + " are ignored");
+        overflowReported = true;
+    }
+
+    hitClusters.clear();
+    hitLights.clear();
+    for (uint32_t i = header.grid[3]; i < count; i++) {
+        const ClusterLight& record = block.lights[i];
+        glm::vec3 center = glm::vec3(view * glm::vec4(glm::vec3(record.positionRange), 1.0f));
+        assignLight(static_cast<uint16_t>(i), center, record.positionRange.w);
+    }
+
+    // Counting sort of the hits into one contiguous list per cluster; lights were visited
+    // in order, so every list stays sorted by light index
+    for (auto& cluster : clusters)
+        cluster = ClusterRecord{0, 0};
+    for (uint32_t cluster : hitClusters)
+        clusters[cluster].count++;
+    uint32_t offset = 0;
+    for (auto& cluster : clusters) {
+        cluster.offset = offset;
+        offset += cluster.count;
+        cluster.count = 0;
+    }
+    lightIndices.resize(hitLights.size());
+    for (size_t i = 0; i < hitLights.size(); i++) {
+        ClusterRecord& cluster = clusters[hitClusters[i]];
+        lightIndices[cluster.offset + cluster.count++] = hitLights[i];
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef LIGHT_CLUSTERS_HPP
+#define LIGHT_CLUSTERS_HPP
+
+#include "../components/light.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Shader-facing light record, std140 compatible
+struct ClusterLight {
+    glm::vec4 positionRange;   // world position, range
+    glm::vec4 directionType;   // world direction (towards where the light points), LightType
+    glm::vec4 colorIntensity;  // rgb, intensity
+    glm::vec4 spotScaleOffset; // saturate(dot(-L, dir) * x + y) is the SPOT cone falloff
+};
+
+// Header of the ClusterLightData block, followed by ClusterLight[MAX_CLUSTER_LIGHTS]. Shaders
+// find the cluster of a fragment as
+//   slice = int(logDepth != 0 ? log(viewDepth) * sliceScale + sliceBias
+//                             : viewDepth * sliceScale + sliceBias)
+//   tile  = ivec2(gl_FragCoord.xy / screenSize * grid.xy)
+//   index = tile.x + tile.y * grid.x + slice * grid.x * grid.y
+// then apply lights[0..grid.w) (directional) and the cluster's list from the index buffers.
+struct ClusterLightingHeader {
+    uint32_t grid[4];      // clusters along x, y, z; directional light count
+    uint32_t lightCount;   // directional + clustered
+    uint32_t logDepth;     // 1 for perspective (exponential slices), 0 for orthographic
+    float screenSize[2];   // in pixels
+    float sliceScale;
+    float sliceBias;
+    float nearDistance;
+    float farDistance;
+};
+
+inline constexpr uint32_t MAX_CLUSTER_LIGHTS = 255; // keeps the block within 16 KB
+
+struct ClusterLightingBlock {
+    ClusterLightingHeader header;
+    ClusterLight lights[MAX_CLUSTER_LIGHTS];
+};
+
+// Light range of one cluster inside the light index list
+struct ClusterRecord {
+    uint32_t offset;
+    uint32_t count;
+};
+
+// Clustered forward light assignment. The view frustum is split into a
+// GRID_X x GRID_Y x GRID_Z grid of froxels (screen tiles times depth slices, exponential
+// in perspective), and every POINT/SPOT light is tested as a sphere against the view-space
+// AABBs of the clusters it can reach, a whole slice of tiles per SIMD pass. The result is
+// one light list and one compact (offset, count) + index pair per frame, so shading cost
+// follows the number of lights near a fragment rather than the total.
+// DIRECTIONAL lights reach every cluster and are kept at the front of the list instead.
+class LightClusterGrid {
+  public:
+    static constexpr uint32_t GRID_X = 16;
+    static constexpr uint32_t GRID_Y = 9;
+    static constexpr uint32_t GRID_Z = 24;
+    static constexpr uint32_t TILES_PER_SLICE = GRID_X * GRID_Y;
+    static constexpr uint32_t CLUSTER_COUNT = TILES_PER_SLICE * GRID_Z;
+
+  private:
+    // Cluster view-space AABBs, structure-of-arrays in slice-major order; rebuilt only
+    // when the projection changes
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+    glm::mat4 cachedProjection = glm::mat4(0.0f);
+
+    ClusterLightingBlock block{};
+    std::vector<ClusterRecord> clusters;
+    std::vector<uint16_t> lightIndices;
+    // (cluster, light) pairs found by the kernel, scattered into lightIndices afterwards
+    std::vector<uint32_t> hitClusters;
+    std::vector<uint16_t> hitLights;
+    bool overflowReported = false;
+
+    void buildClusterBounds(const glm::mat4& projection);
+    float sliceDepth(uint32_t slice) const;
+    int32_t sliceOf(float depth) const;
+    void assignLight(uint16_t lightIndex, const glm::vec3& center, float radius);
+
+  public:
+    LightClusterGrid();
+
+    // near/far and the screen size come from the camera; view and projection are the
+    // matrices the backend bound for it
+    void build(const std::vector<Light*>& lights, const glm::mat4& view,
+               const glm::mat4& projection, bool orthographic, float nearDistance,
+               float farDistance, float screenWidth, float screenHeight);
+
+    const ClusterLightingBlock& getBlock() const { return block; }
+    const std::vector<ClusterRecord>& getClusters() const { return clusters; }
+    const std::vector<uint16_t>& getLightIndices() const { return lightIndices; }
+};
+
+#endif
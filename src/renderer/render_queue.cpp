@@ -0,0 +1,86 @@
+#include "render_queue.hpp"
+#include <algorithm>
+
+namespace {
+constexpr uint32_t PROGRAM_BITS = 10;
+constexpr uint32_t MATERIAL_BITS = 14;
+constexpr uint32_t GEOMETRY_BITS = 14;
+constexpr uint32_t DEPTH_BITS = 24;
+
+constexpr uint64_t mask(uint32_t bits) { return (uint64_t{1} << bits) - 1; }
+} // namespace
+
+uint64_t RenderQueue::makeKey(RenderPass pass, const RenderItem& item, float depth) {
+    auto program = item.material->getShaderProgram();
+    uint64_t programId = program ? program->getId() & mask(PROGRAM_BITS) : 0;
+    uint64_t materialId = item.material->getId() & mask(MATERIAL_BITS);
+    uint64_t geometryId =
+        (item.mesh ? item.mesh->getId() : item.sprite->getTexture()) & mask(GEOMETRY_BITS);
+    uint64_t quantizedDepth =
+        static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * mask(DEPTH_BITS));
+
+    uint64_t key = static_cast<uint64_t>(pass) << 62;
+    if (pass == RenderPass::TRANSPARENT_PASS) {
+        // Far to near, state only breaks ties
+        uint64_t farFirst = mask(DEPTH_BITS) - quantizedDepth;
+        uint64_t state = (programId << (GEOMETRY_BITS + MATERIAL_BITS)) |
+                         (geometryId << MATERIAL_BITS) | materialId;
+        key |= (farFirst << (PROGRAM_BITS + MATERIAL_BITS + GEOMETRY_BITS)) | state;
+    } else {
+        uint64_t state = (programId << (GEOMETRY_BITS + MATERIAL_BITS)) |
+                         (geometryId << MATERIAL_BITS) | materialId;
+        key |= (state << DEPTH_BITS) | quantizedDepth;
+    }
+    return key;
+}
+
+void RenderQueue::clear() {
+    items.clear();
+    keys.clear();
+    order.clear();
+}
+
+void RenderQueue::add(const RenderItem& item, RenderPass pass, float depth) {
+    order.push_back(static_cast<uint32_t>(items.size()));
+    keys.push_back(makeKey(pass, item, depth));
+    items.push_back(item);
+}
+
+void RenderQueue::sort() {
+    size_t count = keys.size();
+    if (count < 2)
+        return;
+
+    // All eight byte histograms in a single sweep
+    uint32_t histograms[8][256] = {};
+    for (uint64_t key : keys) {
+        for (int byte = 0; byte < 8; byte++)
+            histograms[byte][(key >> (byte * 8)) & 0xFF]++;
+    }
+
+    keyScratch.resize(count);
+    orderScratch.resize(count);
+    for (int byte = 0; byte < 8; byte++) {
+        uint32_t* histogram = histograms[byte];
+        uint32_t shift = byte * 8;
+
+        // Every key shares this byte: the pass would not move anything
+        if (histogram[(keys[0] >> shift) & 0xFF] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (int bucket = 0; bucket < 256; bucket++) {
+            uint32_t bucketSize = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketSize;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            uint32_t destination = histogram[(keys[i] >> shift) & 0xFF]++;
+            keyScratch[destination] = keys[i];
+            orderScratch[destination] = order[i];
+        }
+        keys.swap(keyScratch);
+        order.swap(orderScratch);
+    }
+}
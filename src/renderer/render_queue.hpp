@@ -0,0 +1,56 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include "../material.hpp"
+#include "../mesh.hpp"
+#include "../sprite.hpp"
+#include "../world_object.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Suffixed because wingdi.h defines OPAQUE and TRANSPARENT as macros
+enum class RenderPass : uint8_t { OPAQUE_PASS = 0, TRANSPARENT_PASS = 1 };
+
+// One draw: exactly one of mesh or sprite is set
+struct RenderItem {
+    WorldObject* object = nullptr;
+    Material* material = nullptr;
+    const Mesh* mesh = nullptr;
+    const Sprite* sprite = nullptr;
+};
+
+// Orders a frame's draws by a 64-bit key so backends can skip redundant state changes.
+//
+//   opaque:      pass:2 | program:10 | geometry:14 | material:14 | depth:24 (front-to-back)
+//   transparent: pass:2 | depth:24 (back-to-front) | program:10 | geometry:14 | material:14
+//
+// geometry is the mesh id, or the texture for sprites. Both passes order geometry before
+// material: every loaded object owns its material, so this is what keeps copies of a mesh
+// adjacent for instancing, and coplanar sprites sharing a texture adjacent for batching.
+// Ids are truncated to their field, so a collision only costs an extra state change, never
+// a wrong draw.
+class RenderQueue {
+  private:
+    std::vector<RenderItem> items;
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> order;
+    std::vector<uint64_t> keyScratch;
+    std::vector<uint32_t> orderScratch;
+
+    static uint64_t makeKey(RenderPass pass, const RenderItem& item, float depth);
+
+  public:
+    void clear();
+    // depth grows away from the camera, normalized and clamped to [0, 1]
+    void add(const RenderItem& item, RenderPass pass, float depth);
+    // LSD radix sort over the keys, stable for equal keys
+    void sort();
+
+    size_t size() const { return order.size(); }
+    bool empty() const { return order.empty(); }
+    // i-th item in sorted order
+    const RenderItem& operator[](size_t i) const { return items[order[i]]; }
+};
+
+#endif
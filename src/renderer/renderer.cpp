@@ -1,9 +1,12 @@
 #define CLASS_NAME "Renderer"
 #include "../log_macros.hpp"
 
+#include "../components/mesh_renderer.hpp"
+#include "../components/sprite_renderer.hpp"
 #include "../world_object.hpp"
 #include "renderer.hpp"
 #include "renderer_factory.hpp"
+#include <cmath>
 
 
 Renderer::~Renderer() {
@@ -44,29 +47,99 @@ void Renderer::render(const Scene& scene) {
         return;
     }
 
+    backend->beginFrame();
+
     // Bind camera
     backend->bindCamera(camera);
 
+    // Assign lights to the camera's clusters
+    if (backend->supportsLightClusters() && backend->getViewProjection()) {
+        lightClusters.build(scene.getLights(), backend->getView(), backend->getProjection(),
+                            camera->isOrthographic(), camera->getNearDistance(),
+                            camera->getFarDistance(), camera->getWidth(), camera->getHeight());
+        backend->uploadLightClusters(lightClusters);
+    }
+
     // Clear screen
     backend->clear(camera);
 
-    // Collect lights
-    std::vector<Light*> lights;
-    for (auto* obj : scene.getLightObjects()) {
-        if (Light* light = obj->getComponent<Light>()) {
-            lights.push_back(light);
+    // Render objects
+    buildRenderQueue(scene, *camera);
+    backend->renderWorldObjects(renderQueue, scene.getLights());
+}
+
+void Renderer::buildRenderQueue(const Scene& scene, const Camera& camera) {
+    renderQueue.clear();
+    culler.clear();
+    candidates.clear();
+    candidatePasses.clear();
+    visible.clear();
+
+    for (const auto& renderable : scene.getRenderables()) {
+        WorldObject* obj = renderable.object;
+        RenderItem item;
+        item.object = obj;
+        RenderPass pass = RenderPass::OPAQUE_PASS;
+        Bounds bounds{};
+        if (renderable.spriteRenderer) {
+            item.material = renderable.spriteRenderer->getMaterial();
+            item.sprite = obj->getSprite();
+            pass = RenderPass::TRANSPARENT_PASS;
+            // Unit quad scaled by the sprite size, as drawn by the backends
+            float halfWidth = item.sprite->getWidth() * 0.5f;
+            float halfHeight = item.sprite->getHeight() * 0.5f;
+            bounds = Bounds{{-halfWidth, -halfHeight, 0.0f}, {halfWidth, halfHeight, 0.0f}};
+        } else {
+            item.material = renderable.meshRenderer->getMaterial();
+            item.mesh = obj->getMesh();
+            if (item.material && item.material->getBaseColor().a < 1.0f)
+                pass = RenderPass::TRANSPARENT_PASS;
+            bounds = item.mesh->getBounds();
         }
+        if (!item.material)
+            continue;
+        // Still compiling: the object appears once its program is ready
+        ShaderProgram* program = item.material->getShaderProgram();
+        if (program && !program->isReady())
+            continue;
+
+        culler.add(bounds, obj->getTransform().getModelMatrix());
+        candidates.push_back(item);
+        candidatePasses.push_back(pass);
     }
 
-    // Render objects
-    std::vector<WorldObject*> renderableObjects;
-    for (auto& obj : scene.getObjectManager()->getObjects()) {
-        if (obj->hasMesh() || obj->hasSprite()) {
-            renderableObjects.push_back(obj.get());
+    const glm::mat4* viewProjection = backend->getViewProjection();
+    if (viewProjection) {
+        culler.cull(*viewProjection, visible);
+    } else {
+        for (uint32_t i = 0; i < candidates.size(); i++)
+            visible.push_back(i);
+    }
+
+    Vector3 eye{};
+    if (WorldObject* cameraObj = camera.getOwner())
+        eye = cameraObj->getTransform().getPosition();
+    float invFar = camera.getFarDistance() > 0.0f ? 1.0f / camera.getFarDistance() : 0.0f;
+
+    for (uint32_t index : visible) {
+        const auto& item = candidates[index];
+        Vector3 position = item.object->getTransform().getPosition();
+        float depth;
+        if (viewProjection) {
+            // Planar depth: objects on a plane facing the camera tie, so coplanar sprites
+            // can be batched instead of being ordered by their distance to the eye
+            glm::vec4 clip = *viewProjection * glm::vec4(position.x, position.y, position.z, 1.0f);
+            depth = clip.w > 0.0f ? clip.z / clip.w * 0.5f + 0.5f : 0.0f;
+        } else {
+            float dx = position.x - eye.x;
+            float dy = position.y - eye.y;
+            float dz = position.z - eye.z;
+            depth = std::sqrt(dx * dx + dy * dy + dz * dz) * invFar;
         }
+        renderQueue.add(item, candidatePasses[index], depth);
     }
 
-    backend->renderWorldObjects(renderableObjects, lights);
+    renderQueue.sort();
 }
 
 void Renderer::present(SDL_Window* window) {
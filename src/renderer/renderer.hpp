@@ -3,6 +3,9 @@
 
 #include "../graphics_api.hpp"
 #include "../scene.hpp"
+#include "frustum_culler.hpp"
+#include "light_clusters.hpp"
+#include "render_queue.hpp"
 #include "renderer_backend.hpp"
 
 class Material;
@@ -10,6 +13,16 @@ class Material;
 class Renderer {
   private:
     RendererBackend* backend = nullptr;
+    // Rebuilt every frame; kept as a member so its storage is reused
+    RenderQueue renderQueue;
+    FrustumCuller culler;
+    // Per-frame scratch, parallel to the culler's boxes
+    std::vector<RenderItem> candidates;
+    std::vector<RenderPass> candidatePasses;
+    std::vector<uint32_t> visible;
+    LightClusterGrid lightClusters;
+
+    void buildRenderQueue(const Scene& scene, const Camera& camera);
 
   public:
     ~Renderer();
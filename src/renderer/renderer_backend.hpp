@@ -5,9 +5,15 @@
 #include "../components/light.hpp"
 #include "../graphics_api.hpp"
 #include "../mesh.hpp"
+#include "../shader_compiler.hpp"
 #include "../shader_program.hpp"
 #include "../sprite.hpp"
+#include "../texture_image.hpp"
 #include "../world_object.hpp"
+#include "light_clusters.hpp"
+#include "render_queue.hpp"
+#include <array>
+#include <glm/glm.hpp>
 #include <memory>
 #include <vector>
 
@@ -18,11 +24,26 @@ class RendererBackend {
   protected:
     Camera* mainCamera = nullptr;
     std::vector<Light*> lights;
+    // Recorded by bindCamera for CPU-side culling and light clustering
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    bool hasViewProjection = false;
+
+    void setViewProjection(const glm::mat4& view, const glm::mat4& projection) {
+        this->view = view;
+        this->projection = projection;
+        viewProjection = projection * view;
+        hasViewProjection = true;
+    }
 
   public:
     virtual ~RendererBackend() = default;
 
-    virtual unsigned int loadTexture(const std::string& path, uint8_t filterType = 0) = 0;
+    // Called once per frame before any other rendering call
+    virtual void beginFrame() {}
+
+    virtual unsigned int loadTexture(const TextureImage& image, uint8_t filterType = 0) = 0;
     virtual void drawSprite(const Sprite& sprite) = 0;
     virtual bool init() = 0;
     virtual bool init(SDL_Window* window) = 0;
@@ -34,7 +55,7 @@ class RendererBackend {
     virtual void draw(const Mesh&) = 0;
     virtual GraphicsAPI getGraphicsAPI() const = 0;
     virtual std::string getShaderExtension() const = 0;
-    virtual unsigned int createCubemapTexture(const std::vector<std::string>& faces) = 0;
+    virtual unsigned int createCubemapTexture(const std::array<TextureImage, 6>& faces) = 0;
     virtual std::unique_ptr<ShaderProgram> createShaderProgram() = 0;
     virtual std::unique_ptr<ShaderCompiler> createShaderCompiler() = 0;
     virtual std::unique_ptr<MeshBuffer> createMeshBuffer() = 0;
@@ -42,7 +63,15 @@ class RendererBackend {
     virtual void setUniforms(ShaderProgram* shaderProgram) = 0;
     virtual unsigned int getRequiredWindowFlags() const = 0;
 
-    virtual void renderWorldObjects(const std::vector<WorldObject*>& objects,
+    // Whether the backend shades from a light cluster grid; the renderer skips building the
+    // grid otherwise and such backends light from renderWorldObjects' list instead
+    virtual bool supportsLightClusters() const { return false; }
+
+    // Called between bindCamera and renderWorldObjects with the frame's light assignment
+    virtual void uploadLightClusters(const LightClusterGrid& /*clusters*/) {}
+
+    // Draws the queue in its sorted order
+    virtual void renderWorldObjects(const RenderQueue& queue,
                                     const std::vector<Light*>& lights) = 0;
 
     virtual void renderSkybox(const Mesh& mesh, unsigned int shaderProgram,
@@ -55,6 +84,13 @@ class RendererBackend {
     }
 
     Camera* getCamera() { return mainCamera; }
+    // nullptr when the backend does not build camera matrices on the CPU
+    const glm::mat4* getViewProjection() const {
+        return hasViewProjection ? &viewProjection : nullptr;
+    }
+    // Only meaningful when getViewProjection() is not null
+    const glm::mat4& getView() const { return view; }
+    const glm::mat4& getProjection() const { return projection; }
 
     void setCamera(Camera* camera) {
         mainCamera = camera;
@@ -0,0 +1,59 @@
+#define CLASS_NAME "ShaderCacheFile"
+#include "../log_macros.hpp"
+
+#include "shader_cache_file.hpp"
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+bool ShaderCacheFile::read(const std::string& name, std::vector<uint8_t>& data) {
+    std::ifstream file(std::filesystem::path(DIRECTORY) / name, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+
+    std::streamoff size = file.tellg();
+    if (size <= 0)
+        return false;
+    data.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), size);
+    return static_cast<bool>(file);
+}
+
+bool ShaderCacheFile::write(const std::string& name, const void* data, size_t size) {
+    std::error_code error;
+    std::filesystem::create_directories(DIRECTORY, error);
+    if (error) {
+        LOG_WARN("Cannot create " + std::string(DIRECTORY) + ": " + error.message());
+        return false;
+    }
+
+    std::filesystem::path path = std::filesystem::path(DIRECTORY) / name;
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!file) {
+            LOG_WARN("Failed to write " + temporary.string());
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        LOG_WARN("Failed to replace " + path.string() + ": " + error.message());
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+uint64_t ShaderCacheFile::hash(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,27 @@
+#ifndef SHADER_CACHE_FILE_HPP
+#define SHADER_CACHE_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Files of the on-disk shader cache, kept in DIRECTORY under the working directory.
+// Backends store driver-specific blobs here (VkPipelineCache data, GL program binaries)
+// and must validate whatever they read back: the files outlive driver updates and GPU
+// swaps, and a missing or unreadable file is simply a cold cache.
+class ShaderCacheFile {
+  public:
+    static constexpr const char* DIRECTORY = "shader_cache";
+
+    // False when the file does not exist or cannot be read
+    static bool read(const std::string& name, std::vector<uint8_t>& data);
+    // Writes a temporary file and renames it over the old one, so a crash mid-write
+    // never leaves a truncated cache behind
+    static bool write(const std::string& name, const void* data, size_t size);
+
+    // 64-bit FNV-1a; pass a previous result as seed to hash several pieces as one
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+};
+
+#endif // SHADER_CACHE_FILE_HPP
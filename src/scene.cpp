@@ -1,7 +1,9 @@
 #include "scene.hpp"
-#include "components/light.hpp"
+#include <algorithm>
 
-Scene::Scene() : objectManager(std::make_unique<WorldObjectManager>()) {}
+Scene::Scene() : objectManager(std::make_unique<WorldObjectManager>()) {
+    objectManager->setListener(this);
+}
 
 WorldObjectManager* Scene::getObjectManager() { return objectManager.get(); }
 
@@ -15,22 +17,48 @@ Camera* Scene::getCamera() const {
     return cameraObject ? cameraObject->getComponent<Camera>() : nullptr;
 }
 
-std::vector<WorldObject*> Scene::getLightObjects() const {
-    std::vector<WorldObject*> result;
-    for (auto& obj : objectManager->getObjects()) {
-        if (obj->hasComponent<Light>()) {
-            result.push_back(obj.get());
-        }
+void Scene::onComponentsChanged(WorldObject& obj) {
+    unregisterObject(obj);
+    registerObject(obj);
+}
+
+void Scene::onObjectRemoved(WorldObject& obj) {
+    unregisterObject(obj);
+    if (cameraObject == &obj)
+        cameraObject = nullptr;
+}
+
+void Scene::registerObject(WorldObject& obj) {
+    Renderable renderable{&obj, nullptr, nullptr};
+    if (obj.hasSprite())
+        renderable.spriteRenderer = obj.getComponent<SpriteRenderer>();
+    else if (obj.hasMesh())
+        renderable.meshRenderer = obj.getComponent<MeshRenderer>();
+
+    if (renderable.meshRenderer || renderable.spriteRenderer) {
+        renderableIndices[&obj] = static_cast<uint32_t>(renderables.size());
+        renderables.push_back(renderable);
     }
-    return result;
+    if (Light* light = obj.getComponent<Light>())
+        lights.push_back(light);
+    if (Camera* camera = obj.getComponent<Camera>())
+        cameras.push_back(camera);
 }
 
-std::vector<WorldObject*> Scene::getRenderableObjects() const {
-    std::vector<WorldObject*> result;
-    for (auto& obj : objectManager->getObjects()) {
-        if (obj->hasMesh() || obj->hasSprite()) {
-            result.push_back(obj.get());
+void Scene::unregisterObject(WorldObject& obj) {
+    auto it = renderableIndices.find(&obj);
+    if (it != renderableIndices.end()) {
+        // Swap with the last entry to keep the array dense
+        uint32_t index = it->second;
+        renderableIndices.erase(it);
+        if (index + 1 != renderables.size()) {
+            renderables[index] = renderables.back();
+            renderableIndices[renderables[index].object] = index;
         }
+        renderables.pop_back();
     }
-    return result;
-}
\ No newline at end of file
+
+    auto ownedBy = [&obj](const Component* comp) { return comp->getOwner() == &obj; };
+    lights.erase(std::remove_if(lights.begin(), lights.end(), ownedBy), lights.end());
+    cameras.erase(std::remove_if(cameras.begin(), cameras.end(), ownedBy), cameras.end());
+}
@@ -2,16 +2,41 @@
 #define SCENE_HPP
 
 #include "components/camera.hpp"
+#include "components/light.hpp"
+#include "components/mesh_renderer.hpp"
+#include "components/sprite_renderer.hpp"
 #include "world_object.hpp"
 #include "world_object_manager.hpp"
+#include <cstdint>
 #include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Registry entry; exactly one of meshRenderer/spriteRenderer is set, and the object has the
+// matching mesh or sprite
+struct Renderable {
+    WorldObject* object;
+    MeshRenderer* meshRenderer;
+    SpriteRenderer* spriteRenderer;
+};
 
-class Scene {
+class Scene : public WorldObjectListener {
   private:
+    // Registries are kept up to date through WorldObjectListener, so the frame path never
+    // scans objects or their components
+    std::vector<Renderable> renderables;
+    std::unordered_map<const WorldObject*, uint32_t> renderableIndices;
+    std::vector<Light*> lights;
+    std::vector<Camera*> cameras;
+
+    // Declared last so objects are destroyed while the registries are still alive
     std::unique_ptr<WorldObjectManager> objectManager;
     // TODO: adicionar suporte para mais de uma camera
     WorldObject* cameraObject = nullptr;
 
+    void registerObject(WorldObject& obj);
+    void unregisterObject(WorldObject& obj);
+
   public:
     Scene();
     ~Scene() = default;
@@ -24,11 +49,12 @@ class Scene {
     WorldObject* getCameraObject() const;
     Camera* getCamera() const;
 
-    // Helper: Get all objects with Light component
-    std::vector<WorldObject*> getLightObjects() const;
+    const std::vector<Renderable>& getRenderables() const { return renderables; }
+    const std::vector<Light*>& getLights() const { return lights; }
+    const std::vector<Camera*>& getCameras() const { return cameras; }
 
-    // Helper: Get all objects with MeshRenderer
-    std::vector<WorldObject*> getRenderableObjects() const;
+    void onComponentsChanged(WorldObject& obj) override;
+    void onObjectRemoved(WorldObject& obj) override;
 };
 
-#endif
\ No newline at end of file
+#endif
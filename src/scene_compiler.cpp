@@ -1,39 +1,905 @@
 #include "color.hpp"
+#include "mesh_buffer.hpp"
 #include "scene_format.hpp"
+#include "texture_image.hpp"
 #include "vector3.hpp"
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tinyobjloader/tiny_obj_loader.h"
+
 using json = nlohmann::json;
 
-void compileMeshRenderer(ComponentData& compData, const json& comp) {
-    compData.type = ComponentType::MESH_RENDERER;
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Deduplicated string storage, serialized as the STRINGS chunk
+class StringTable {
+  private:
+    std::unordered_map<std::string, uint32_t> indices;
+    std::vector<uint32_t> offsets;
+    std::vector<char> characters;
+
+  public:
+    uint32_t add(const std::string& value) {
+        auto result = indices.try_emplace(value, static_cast<uint32_t>(offsets.size()));
+        if (result.second) {
+            offsets.push_back(static_cast<uint32_t>(characters.size()));
+            characters.insert(characters.end(), value.begin(), value.end());
+            characters.push_back('\0');
+        }
+        return result.first->second;
+    }
+
+    size_t size() const { return offsets.size(); }
+
+    std::vector<uint8_t> serialize() const {
+        uint32_t count = static_cast<uint32_t>(offsets.size());
+        std::vector<uint8_t> chunk(sizeof(uint32_t) * (1 + count) + characters.size());
+        std::memcpy(chunk.data(), &count, sizeof(count));
+        if (count > 0) {
+            std::memcpy(chunk.data() + sizeof(uint32_t), offsets.data(), count * sizeof(uint32_t));
+            std::memcpy(chunk.data() + sizeof(uint32_t) * (1 + count), characters.data(),
+                        characters.size());
+        }
+        return chunk;
+    }
+};
+
+// Bakes each (OBJ, shadeSmooth) pair once, serialized as the MESHES chunk
+class MeshBaker {
+  private:
+    struct BakedMesh {
+        uint32_t path;
+        bool shadeSmooth;
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<uint32_t> indices;
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    std::map<std::pair<std::string, bool>, uint32_t> indices;
+    std::vector<BakedMesh> meshes;
+
+    // Collapses corners that share both position and normal into a single indexed vertex
+    static void weld(BakedMesh& mesh) {
+        std::map<std::array<float, 6>, uint32_t> unique;
+        std::vector<float> positions, normals;
+        size_t cornerCount = mesh.positions.size() / 3;
+        mesh.indices.resize(cornerCount);
+
+        for (size_t i = 0; i < cornerCount; i++) {
+            std::array<float, 6> key = {mesh.positions[i * 3 + 0], mesh.positions[i * 3 + 1],
+                                        mesh.positions[i * 3 + 2], mesh.normals[i * 3 + 0],
+                                        mesh.normals[i * 3 + 1],   mesh.normals[i * 3 + 2]};
+            auto result = unique.try_emplace(key, static_cast<uint32_t>(positions.size() / 3));
+            if (result.second) {
+                positions.insert(positions.end(), key.begin(), key.begin() + 3);
+                normals.insert(normals.end(), key.begin() + 3, key.end());
+            }
+            mesh.indices[i] = result.first->second;
+        }
+
+        mesh.positions = std::move(positions);
+        mesh.normals = std::move(normals);
+    }
+
+    static bool bake(const std::string& filepath, bool shadeSmooth, BakedMesh& mesh) {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string err;
+
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, filepath.c_str())) {
+            std::cerr << "Unable to load obj: " << filepath << " " << err << std::endl;
+            return false;
+        }
+
+        bool useFileNormals = shadeSmooth && !attrib.normals.empty();
+        for (const auto& shape : shapes) {
+            for (size_t f = 0; f + 2 < shape.mesh.indices.size(); f += 3) {
+                float v[3][3];
+                for (int i = 0; i < 3; i++) {
+                    int vertexIndex = shape.mesh.indices[f + i].vertex_index;
+                    for (int axis = 0; axis < 3; axis++)
+                        v[i][axis] = attrib.vertices[3 * vertexIndex + axis];
+                }
+
+                float edge1[3] = {v[1][0] - v[0][0], v[1][1] - v[0][1], v[1][2] - v[0][2]};
+                float edge2[3] = {v[2][0] - v[0][0], v[2][1] - v[0][1], v[2][2] - v[0][2]};
+                float faceNormal[3] = {edge1[1] * edge2[2] - edge1[2] * edge2[1],
+                                       edge1[2] * edge2[0] - edge1[0] * edge2[2],
+                                       edge1[0] * edge2[1] - edge1[1] * edge2[0]};
+
+                float len = std::sqrt(faceNormal[0] * faceNormal[0] +
+                                      faceNormal[1] * faceNormal[1] +
+                                      faceNormal[2] * faceNormal[2]);
+                if (len > 0) {
+                    faceNormal[0] /= len;
+                    faceNormal[1] /= len;
+                    faceNormal[2] /= len;
+                }
+
+                for (int i = 0; i < 3; i++) {
+                    int normalIndex = shape.mesh.indices[f + i].normal_index;
+                    for (int axis = 0; axis < 3; axis++) {
+                        mesh.positions.push_back(v[i][axis]);
+                        // Smooth shading keeps the authored normals; anything else is flat
+                        mesh.normals.push_back(useFileNormals && normalIndex >= 0
+                                                   ? attrib.normals[3 * normalIndex + axis]
+                                                   : faceNormal[axis]);
+                    }
+                }
+            }
+        }
+
+        weld(mesh);
+
+        for (int axis = 0; axis < 3; axis++) {
+            mesh.boundsMin[axis] = mesh.positions.empty() ? 0.0f : mesh.positions[axis];
+            mesh.boundsMax[axis] = mesh.boundsMin[axis];
+        }
+        for (size_t i = 0; i < mesh.positions.size(); i += 3) {
+            for (int axis = 0; axis < 3; axis++) {
+                mesh.boundsMin[axis] = std::min(mesh.boundsMin[axis], mesh.positions[i + axis]);
+                mesh.boundsMax[axis] = std::max(mesh.boundsMax[axis], mesh.positions[i + axis]);
+            }
+        }
+        return true;
+    }
+
+  public:
+    // Returns false when the OBJ cannot be loaded
+    bool add(const std::string& filepath, bool shadeSmooth, StringTable& strings,
+             uint32_t& index) {
+        auto key = std::make_pair(filepath, shadeSmooth);
+        auto it = indices.find(key);
+        if (it != indices.end()) {
+            index = it->second;
+            return true;
+        }
+
+        BakedMesh mesh{};
+        mesh.path = strings.add(filepath);
+        mesh.shadeSmooth = shadeSmooth;
+        if (!bake(filepath, shadeSmooth, mesh))
+            return false;
+
+        index = static_cast<uint32_t>(meshes.size());
+        indices.emplace(key, index);
+        meshes.push_back(std::move(mesh));
+        return true;
+    }
+
+    size_t size() const { return meshes.size(); }
+
+    std::vector<uint8_t> serialize() const {
+        MeshChunkHeader header{};
+        header.meshCount = static_cast<uint32_t>(meshes.size());
+
+        std::vector<BakedMeshData> table(meshes.size());
+        size_t offset = alignUp(sizeof(MeshChunkHeader) + table.size() * sizeof(BakedMeshData),
+                                SCENE_CHUNK_ALIGNMENT);
+        for (size_t i = 0; i < meshes.size(); i++) {
+            auto& entry = table[i];
+            entry.path = meshes[i].path;
+            entry.shadeSmooth = meshes[i].shadeSmooth ? 1 : 0;
+            entry.vertexCount = static_cast<uint32_t>(meshes[i].positions.size() / 3);
+            std::memcpy(entry.boundsMin, meshes[i].boundsMin, sizeof(entry.boundsMin));
+            std::memcpy(entry.boundsMax, meshes[i].boundsMax, sizeof(entry.boundsMax));
+
+            entry.indexCount = static_cast<uint32_t>(meshes[i].indices.size());
+            IndexType indexType =
+                entry.vertexCount <= 0x10000 ? IndexType::UINT16 : IndexType::UINT32;
+            entry.indexType = static_cast<uint8_t>(indexType);
+
+            entry.vertexStride = VertexLayout::positionNormal().stride;
+            entry.verticesOffset = offset;
+            offset = alignUp(offset + static_cast<size_t>(entry.vertexCount) * entry.vertexStride,
+                             SCENE_CHUNK_ALIGNMENT);
+            entry.indicesOffset = offset;
+            offset = alignUp(offset + entry.indexCount * getIndexSize(indexType),
+                             SCENE_CHUNK_ALIGNMENT);
+        }
+
+        std::vector<uint8_t> chunk(offset, 0);
+        std::memcpy(chunk.data(), &header, sizeof(header));
+        if (!table.empty())
+            std::memcpy(chunk.data() + sizeof(header), table.data(),
+                        table.size() * sizeof(BakedMeshData));
+        for (size_t i = 0; i < meshes.size(); i++) {
+            if (table[i].vertexCount == 0)
+                continue;
+            // Interleave as position + normal so the loader can upload a single buffer
+            uint8_t* vertices = chunk.data() + table[i].verticesOffset;
+            for (uint32_t v = 0; v < table[i].vertexCount; v++) {
+                uint8_t* vertex = vertices + static_cast<size_t>(v) * table[i].vertexStride;
+                std::memcpy(vertex, &meshes[i].positions[v * 3], 3 * sizeof(float));
+                std::memcpy(vertex + 3 * sizeof(float), &meshes[i].normals[v * 3],
+                            3 * sizeof(float));
+            }
+
+            uint8_t* indices = chunk.data() + table[i].indicesOffset;
+            for (size_t j = 0; j < meshes[i].indices.size(); j++) {
+                if (static_cast<IndexType>(table[i].indexType) == IndexType::UINT16) {
+                    uint16_t index = static_cast<uint16_t>(meshes[i].indices[j]);
+                    std::memcpy(indices + j * sizeof(index), &index, sizeof(index));
+                } else {
+                    std::memcpy(indices + j * sizeof(uint32_t), &meshes[i].indices[j],
+                                sizeof(uint32_t));
+                }
+            }
+        }
+        return chunk;
+    }
+};
+
+// Block compression (BC1/BC3) with a range-fit endpoint search: the endpoints are the
+// extremes of the block along its principal colour axis
+namespace bc {
+
+static uint16_t packRGB565(const float color[3]) {
+    auto quantize = [](float value, int maxValue) {
+        int q = static_cast<int>(value / 255.0f * maxValue + 0.5f);
+        return std::clamp(q, 0, maxValue);
+    };
+    return static_cast<uint16_t>((quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) |
+                                 quantize(color[2], 31));
+}
+
+static void unpackRGB565(uint16_t packed, float color[3]) {
+    int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = static_cast<float>((r << 3) | (r >> 2));
+    color[1] = static_cast<float>((g << 2) | (g >> 4));
+    color[2] = static_cast<float>((b << 3) | (b >> 2));
+}
+
+// Always uses the four-colour mode (color0 > color1), as BC3 requires
+static void encodeColorBlock(const uint8_t block[16][4], uint8_t out[8]) {
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; i++)
+        for (int c = 0; c < 3; c++)
+            mean[c] += block[i][c] / 16.0f;
+
+    float cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; i++) {
+        float d[3] = {block[i][0] - mean[0], block[i][1] - mean[1], block[i][2] - mean[2]};
+        cov[0] += d[0] * d[0];
+        cov[1] += d[0] * d[1];
+        cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1];
+        cov[4] += d[1] * d[2];
+        cov[5] += d[2] * d[2];
+    }
+
+    // Power iteration for the principal axis
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[3] = {cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                         cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                         cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]};
+        float len = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (len < 1e-6f)
+            break;
+        for (int c = 0; c < 3; c++)
+            axis[c] = next[c] / len;
+    }
+
+    float minProj = 1e30f, maxProj = -1e30f;
+    for (int i = 0; i < 16; i++) {
+        float proj = (block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] +
+                     (block[i][2] - mean[2]) * axis[2];
+        minProj = std::min(minProj, proj);
+        maxProj = std::max(maxProj, proj);
+    }
+
+    float endpoint0[3], endpoint1[3];
+    for (int c = 0; c < 3; c++) {
+        endpoint0[c] = std::clamp(mean[c] + axis[c] * maxProj, 0.0f, 255.0f);
+        endpoint1[c] = std::clamp(mean[c] + axis[c] * minProj, 0.0f, 255.0f);
+    }
+
+    uint16_t color0 = packRGB565(endpoint0);
+    uint16_t color1 = packRGB565(endpoint1);
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        float palette[4][3];
+        unpackRGB565(color0, palette[0]);
+        unpackRGB565(color1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        }
+
+        for (int i = 0; i < 16; i++) {
+            uint32_t best = 0;
+            float bestError = 1e30f;
+            for (uint32_t p = 0; p < 4; p++) {
+                float error = 0.0f;
+                for (int c = 0; c < 3; c++) {
+                    float d = block[i][c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= best << (2 * i);
+        }
+    }
+
+    std::memcpy(out, &color0, 2);
+    std::memcpy(out + 2, &color1, 2);
+    std::memcpy(out + 4, &indices, 4);
+}
+
+static void encodeAlphaBlock(const uint8_t block[16][4], uint8_t out[8]) {
+    uint8_t alpha0 = 0, alpha1 = 255;
+    for (int i = 0; i < 16; i++) {
+        alpha0 = std::max(alpha0, block[i][3]);
+        alpha1 = std::min(alpha1, block[i][3]);
+    }
+
+    uint64_t indices = 0;
+    if (alpha0 != alpha1) {
+        // Eight-value mode (alpha0 > alpha1)
+        float palette[8] = {static_cast<float>(alpha0), static_cast<float>(alpha1)};
+        for (int p = 1; p < 7; p++)
+            palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7.0f;
+
+        for (int i = 0; i < 16; i++) {
+            uint64_t best = 0;
+            float bestError = 1e30f;
+            for (uint64_t p = 0; p < 8; p++) {
+                float error = std::abs(block[i][3] - palette[p]);
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= best << (3 * i);
+        }
+    }
+
+    out[0] = alpha0;
+    out[1] = alpha1;
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+}
+
+static std::vector<uint8_t> encode(const uint8_t* rgba, uint32_t width, uint32_t height,
+                                   TextureFormat format) {
+    uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    size_t blockSize = format == TextureFormat::BC1 ? 8 : 16;
+    std::vector<uint8_t> out(blocksX * blocksY * blockSize);
+
+    uint8_t block[16][4];
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            // Levels smaller than a block repeat their edge texels
+            for (uint32_t y = 0; y < 4; y++) {
+                for (uint32_t x = 0; x < 4; x++) {
+                    uint32_t sx = std::min(bx * 4 + x, width - 1);
+                    uint32_t sy = std::min(by * 4 + y, height - 1);
+                    std::memcpy(block[y * 4 + x], rgba + (sy * width + sx) * 4, 4);
+                }
+            }
+
+            uint8_t* dst = out.data() + (by * blocksX + bx) * blockSize;
+            if (format == TextureFormat::BC3) {
+                encodeAlphaBlock(block, dst);
+                dst += 8;
+            }
+            encodeColorBlock(block, dst);
+        }
+    }
+    return out;
+}
+
+} // namespace bc
+
+// Loads an image as RGBA8; returns false when it cannot be decoded
+static bool decodeImage(const std::string& filepath, std::vector<uint8_t>& pixels,
+                        uint32_t& width, uint32_t& height) {
+    int w, h, channels;
+    unsigned char* data = stbi_load(filepath.c_str(), &w, &h, &channels, 4);
+    if (!data) {
+        std::cerr << "Failed to load texture: " << filepath << std::endl;
+        return false;
+    }
+
+    pixels.assign(data, data + static_cast<size_t>(w) * h * 4);
+    stbi_image_free(data);
+    width = static_cast<uint32_t>(w);
+    height = static_cast<uint32_t>(h);
+    return true;
+}
+
+// Decodes each (image, filter) pair once, builds its mip chain and encodes it; serialized
+// as the TEXTURES chunk
+class TextureBaker {
+  private:
+    struct BakedLevel {
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint8_t> data;
+    };
+
+    struct BakedTexture {
+        uint32_t path;
+        TextureFormat format;
+        uint8_t filterType;
+        std::vector<BakedLevel> levels;
+    };
+
+    std::map<std::pair<std::string, uint8_t>, uint32_t> indices;
+    std::vector<BakedTexture> textures;
+
+    static std::vector<uint8_t> downsample(const std::vector<uint8_t>& src, uint32_t width,
+                                           uint32_t height, uint32_t dstWidth,
+                                           uint32_t dstHeight) {
+        std::vector<uint8_t> dst(dstWidth * dstHeight * 4);
+        for (uint32_t y = 0; y < dstHeight; y++) {
+            for (uint32_t x = 0; x < dstWidth; x++) {
+                uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+                uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+                for (uint32_t c = 0; c < 4; c++) {
+                    uint32_t sum = src[(y0 * width + x0) * 4 + c] + src[(y0 * width + x1) * 4 + c] +
+                                   src[(y1 * width + x0) * 4 + c] + src[(y1 * width + x1) * 4 + c];
+                    dst[(y * dstWidth + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+        return dst;
+    }
+
+    static void bake(std::vector<uint8_t> level, uint32_t width, uint32_t height,
+                     uint8_t filterType, uint32_t maxLevels, BakedTexture& texture) {
+        bool hasAlpha = false;
+        for (size_t i = 3; i < level.size() && !hasAlpha; i += 4)
+            hasAlpha = level[i] != 255;
+
+        // Pixel art (NEAREST) stays uncompressed at full resolution only; block formats
+        // also need a base level that is a multiple of 4
+        bool mipmapped = filterType == 1;
+        if (filterType == 1 && width % 4 == 0 && height % 4 == 0)
+            texture.format = hasAlpha ? TextureFormat::BC3 : TextureFormat::BC1;
+        else
+            texture.format = TextureFormat::RGBA8;
+
+        uint32_t levelWidth = width, levelHeight = height;
+        while (true) {
+            BakedLevel baked{levelWidth, levelHeight, {}};
+            baked.data = texture.format == TextureFormat::RGBA8
+                             ? level
+                             : bc::encode(level.data(), levelWidth, levelHeight, texture.format);
+            texture.levels.push_back(std::move(baked));
+
+            if (!mipmapped || (levelWidth == 1 && levelHeight == 1) ||
+                texture.levels.size() == maxLevels)
+                break;
+
+            uint32_t nextWidth = std::max(1u, levelWidth / 2);
+            uint32_t nextHeight = std::max(1u, levelHeight / 2);
+            level = downsample(level, levelWidth, levelHeight, nextWidth, nextHeight);
+            levelWidth = nextWidth;
+            levelHeight = nextHeight;
+        }
+    }
+
+  public:
+    // Returns false when the image cannot be decoded
+    bool add(const std::string& filepath, uint8_t filterType, StringTable& strings,
+             uint32_t& index) {
+        auto key = std::make_pair(filepath, filterType);
+        auto it = indices.find(key);
+        if (it != indices.end()) {
+            index = it->second;
+            return true;
+        }
+
+        std::vector<uint8_t> pixels;
+        uint32_t width, height;
+        if (!decodeImage(filepath, pixels, width, height))
+            return false;
+
+        index = addImage(filepath, std::move(pixels), width, height, filterType,
+                         TEXTURE_MAX_LEVELS, strings);
+        indices.emplace(key, index);
+        return true;
+    }
+
+    // Bakes already decoded RGBA8 pixels; name only identifies the texture in the STRINGS
+    // chunk. Returns the texture index
+    uint32_t addImage(const std::string& name, std::vector<uint8_t> pixels, uint32_t width,
+                      uint32_t height, uint8_t filterType, uint32_t maxLevels,
+                      StringTable& strings) {
+        BakedTexture texture{};
+        texture.path = strings.add(name);
+        texture.filterType = filterType;
+        bake(std::move(pixels), width, height, filterType, maxLevels, texture);
+
+        textures.push_back(std::move(texture));
+        return static_cast<uint32_t>(textures.size() - 1);
+    }
+
+    uint32_t getWidth(uint32_t index) const { return textures[index].levels[0].width; }
+    uint32_t getHeight(uint32_t index) const { return textures[index].levels[0].height; }
+    size_t size() const { return textures.size(); }
+
+    std::vector<uint8_t> serialize() const {
+        TextureChunkHeader header{};
+        header.textureCount = static_cast<uint32_t>(textures.size());
+
+        std::vector<BakedTextureData> table(textures.size());
+        std::vector<BakedTextureLevel> levels;
+        for (size_t i = 0; i < textures.size(); i++) {
+            table[i].path = textures[i].path;
+            table[i].format = static_cast<uint8_t>(textures[i].format);
+            table[i].filterType = textures[i].filterType;
+            table[i].levelCount = static_cast<uint8_t>(textures[i].levels.size());
+            table[i].firstLevel = static_cast<uint32_t>(levels.size());
+            for (const auto& level : textures[i].levels) {
+                levels.push_back(
+                    BakedTextureLevel{level.width, level.height, 0, level.data.size()});
+            }
+        }
+        header.levelCount = static_cast<uint32_t>(levels.size());
+
+        size_t offset = alignUp(sizeof(TextureChunkHeader) +
+                                    table.size() * sizeof(BakedTextureData) +
+                                    levels.size() * sizeof(BakedTextureLevel),
+                                SCENE_CHUNK_ALIGNMENT);
+        for (auto& level : levels) {
+            level.offset = offset;
+            offset = alignUp(offset + level.size, SCENE_CHUNK_ALIGNMENT);
+        }
+
+        std::vector<uint8_t> chunk(offset, 0);
+        uint8_t* dst = chunk.data();
+        std::memcpy(dst, &header, sizeof(header));
+        dst += sizeof(header);
+        if (!table.empty())
+            std::memcpy(dst, table.data(), table.size() * sizeof(BakedTextureData));
+        dst += table.size() * sizeof(BakedTextureData);
+        if (!levels.empty())
+            std::memcpy(dst, levels.data(), levels.size() * sizeof(BakedTextureLevel));
+
+        size_t levelIndex = 0;
+        for (const auto& texture : textures) {
+            for (const auto& level : texture.levels) {
+                std::memcpy(chunk.data() + levels[levelIndex++].offset, level.data.data(),
+                            level.data.size());
+            }
+        }
+        return chunk;
+    }
+};
+
+// Bottom-left skyline bin packer over a fixed-size page
+class SkylinePacker {
+  private:
+    struct Segment {
+        uint32_t x;
+        uint32_t y; // height of the skyline over [x, x + width)
+        uint32_t width;
+    };
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t usedHeight = 0;
+    std::vector<Segment> skyline;
+
+    // Height a rect would rest at when its left edge sits on segment index; false when it
+    // runs past the right or top edge
+    bool fit(size_t index, uint32_t rectWidth, uint32_t rectHeight, uint32_t& y) const {
+        uint32_t x = skyline[index].x;
+        if (x + rectWidth > width)
+            return false;
+
+        y = 0;
+        uint32_t remaining = rectWidth;
+        for (size_t i = index; remaining > 0; i++) {
+            y = std::max(y, skyline[i].y);
+            if (y + rectHeight > height)
+                return false;
+            remaining -= std::min(remaining, skyline[i].width);
+        }
+        return true;
+    }
+
+  public:
+    SkylinePacker(uint32_t width, uint32_t height)
+        : width(width), height(height), skyline{{0, 0, width}} {}
+
+    bool insert(uint32_t rectWidth, uint32_t rectHeight, uint32_t& x, uint32_t& y) {
+        size_t best = skyline.size();
+        uint32_t bestY = 0, bestWidth = 0;
+        for (size_t i = 0; i < skyline.size(); i++) {
+            uint32_t candidateY;
+            if (!fit(i, rectWidth, rectHeight, candidateY))
+                continue;
+            // Lowest top edge first, then the narrowest segment to limit wasted gaps
+            if (best == skyline.size() || candidateY < bestY ||
+                (candidateY == bestY && skyline[i].width < bestWidth)) {
+                best = i;
+                bestY = candidateY;
+                bestWidth = skyline[i].width;
+            }
+        }
+        if (best == skyline.size())
+            return false;
+
+        x = skyline[best].x;
+        y = bestY;
+        usedHeight = std::max(usedHeight, y + rectHeight);
+
+        // The new segment replaces everything it shadows
+        skyline.insert(skyline.begin() + best, Segment{x, y + rectHeight, rectWidth});
+        size_t i = best + 1;
+        while (i < skyline.size() && skyline[i].x < x + rectWidth) {
+            uint32_t shadowed = x + rectWidth - skyline[i].x;
+            if (shadowed >= skyline[i].width) {
+                skyline.erase(skyline.begin() + i);
+            } else {
+                skyline[i].x += shadowed;
+                skyline[i].width -= shadowed;
+                break;
+            }
+        }
+        // Merge neighbours at the same height
+        for (size_t j = 0; j + 1 < skyline.size();) {
+            if (skyline[j].y == skyline[j + 1].y) {
+                skyline[j].width += skyline[j + 1].width;
+                skyline.erase(skyline.begin() + j + 1);
+            } else {
+                j++;
+            }
+        }
+        return true;
+    }
+
+    uint32_t getWidth() const { return width; }
+    uint32_t getUsedHeight() const { return usedHeight; }
+};
+
+// Collects the images referenced by sprite renderers and packs them into shared atlas
+// pages, so sprites can be batched under one texture. Pages are baked as regular
+// textures; each sprite payload is patched with its page and UV rect once packed.
+class SpriteAtlas {
+  private:
+    static constexpr uint32_t MIN_PAGE_SIZE = 256;
+    static constexpr uint32_t MAX_PAGE_SIZE = 2048;
+    // Border around each image, filled by extruding its edge texels, so filtering never
+    // picks up a neighbour. Cells also stay on 4-texel boundaries, so no compressed block
+    // mixes two images
+    static constexpr uint32_t PADDING = 4;
+    // Mip levels whose padding is still at least one texel wide
+    static constexpr uint32_t MAX_LEVELS = 3;
+
+    struct Image {
+        std::string path;
+        uint8_t filterType;
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint8_t> pixels;
+        // Filled by build()
+        uint32_t texture = 0;
+        float uvRect[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+    };
+
+    struct Placement {
+        uint32_t image;
+        uint32_t x;
+        uint32_t y;
+    };
+
+    std::map<std::pair<std::string, uint8_t>, uint32_t> indices;
+    std::vector<Image> images;
+    // Stream offsets of the SpriteRendererComponentData payloads, with their image
+    std::vector<std::pair<size_t, uint32_t>> references;
+    uint32_t pageCount = 0;
+
+    static uint32_t cellSize(uint32_t size) {
+        return static_cast<uint32_t>(alignUp(size + 2 * PADDING, 4));
+    }
+
+    // Packs every image of the group into as few pages of pageSize as possible. Below
+    // MAX_PAGE_SIZE a single page is required, so the caller can try the next size up
+    bool pack(const std::vector<uint32_t>& group, uint32_t pageSize,
+              std::vector<SkylinePacker>& pages,
+              std::vector<std::vector<Placement>>& placements) const {
+        pages.clear();
+        placements.clear();
+        for (uint32_t index : group) {
+            const Image& image = images[index];
+            uint32_t x = 0, y = 0;
+            size_t page = 0;
+            while (page < pages.size() &&
+                   !pages[page].insert(cellSize(image.width), cellSize(image.height), x, y))
+                page++;
+
+            if (page == pages.size()) {
+                if (!pages.empty() && pageSize < MAX_PAGE_SIZE)
+                    return false;
+                pages.emplace_back(pageSize, pageSize);
+                placements.emplace_back();
+                if (!pages.back().insert(cellSize(image.width), cellSize(image.height), x, y))
+                    return false;
+            }
+            placements[page].push_back(Placement{index, x, y});
+        }
+        return true;
+    }
+
+    void bakePage(const SkylinePacker& page, const std::vector<Placement>& placements,
+                  uint8_t filterType, TextureBaker& textures, StringTable& strings) {
+        uint32_t pageWidth = page.getWidth();
+        uint32_t pageHeight = static_cast<uint32_t>(alignUp(page.getUsedHeight(), 4));
+        std::vector<uint8_t> pixels(static_cast<size_t>(pageWidth) * pageHeight * 4, 0);
+
+        for (const auto& placement : placements) {
+            const Image& image = images[placement.image];
+            uint32_t cellWidth = cellSize(image.width), cellHeight = cellSize(image.height);
+            for (uint32_t y = 0; y < cellHeight; y++) {
+                uint32_t sy = std::min(y > PADDING ? y - PADDING : 0, image.height - 1);
+                for (uint32_t x = 0; x < cellWidth; x++) {
+                    uint32_t sx = std::min(x > PADDING ? x - PADDING : 0, image.width - 1);
+                    size_t dst = (static_cast<size_t>(placement.y + y) * pageWidth +
+                                  placement.x + x) * 4;
+                    std::memcpy(&pixels[dst], &image.pixels[(sy * image.width + sx) * 4], 4);
+                }
+            }
+        }
+
+        std::string name = "atlas#" + std::to_string(pageCount++);
+        uint32_t texture = textures.addImage(name, std::move(pixels), pageWidth, pageHeight,
+                                             filterType, MAX_LEVELS, strings);
+
+        for (const auto& placement : placements) {
+            Image& image = images[placement.image];
+            image.texture = texture;
+            image.uvRect[0] = static_cast<float>(placement.x + PADDING) / pageWidth;
+            image.uvRect[1] = static_cast<float>(placement.y + PADDING) / pageHeight;
+            image.uvRect[2] = static_cast<float>(placement.x + PADDING + image.width) / pageWidth;
+            image.uvRect[3] =
+                static_cast<float>(placement.y + PADDING + image.height) / pageHeight;
+        }
+    }
+
+  public:
+    // Returns false when the image cannot be decoded
+    bool add(const std::string& filepath, uint8_t filterType, uint32_t& index) {
+        auto key = std::make_pair(filepath, filterType);
+        auto it = indices.find(key);
+        if (it != indices.end()) {
+            index = it->second;
+            return true;
+        }
+
+        Image image{filepath, filterType, 0, 0, {}};
+        if (!decodeImage(filepath, image.pixels, image.width, image.height))
+            return false;
+
+        index = static_cast<uint32_t>(images.size());
+        indices.emplace(key, index);
+        images.push_back(std::move(image));
+        return true;
+    }
+
+    uint32_t getWidth(uint32_t index) const { return images[index].width; }
+    uint32_t getHeight(uint32_t index) const { return images[index].height; }
+
+    void reference(size_t payloadOffset, uint32_t index) {
+        references.emplace_back(payloadOffset, index);
+    }
+
+    void build(TextureBaker& textures, StringTable& strings, std::vector<uint8_t>& stream) {
+        // Filtering decides the texture format and mip chain, so each filter gets its own
+        // pages; tallest first packs best on a skyline
+        for (uint8_t filterType : {uint8_t{0}, uint8_t{1}}) {
+            std::vector<uint32_t> group;
+            for (uint32_t i = 0; i < images.size(); i++) {
+                if (images[i].filterType != filterType)
+                    continue;
+                // Images that cannot share a page keep a texture of their own
+                if (cellSize(images[i].width) > MAX_PAGE_SIZE ||
+                    cellSize(images[i].height) > MAX_PAGE_SIZE) {
+                    images[i].texture = textures.addImage(
+                        images[i].path, std::move(images[i].pixels), images[i].width,
+                        images[i].height, filterType, TEXTURE_MAX_LEVELS, strings);
+                    continue;
+                }
+                group.push_back(i);
+            }
+            if (group.empty())
+                continue;
+            std::stable_sort(group.begin(), group.end(), [&](uint32_t a, uint32_t b) {
+                return images[a].height > images[b].height;
+            });
+
+            std::vector<SkylinePacker> pages;
+            std::vector<std::vector<Placement>> placements;
+            uint32_t pageSize = MIN_PAGE_SIZE;
+            while (!pack(group, pageSize, pages, placements))
+                pageSize *= 2;
+
+            for (size_t page = 0; page < pages.size(); page++)
+                bakePage(pages[page], placements[page], filterType, textures, strings);
+        }
+
+        for (const auto& [offset, index] : references) {
+            SpriteRendererComponentData payload;
+            std::memcpy(&payload, stream.data() + offset, sizeof(payload));
+            payload.texture.texture = images[index].texture;
+            std::memcpy(payload.texture.uvRect, images[index].uvRect, sizeof(float) * 4);
+            std::memcpy(stream.data() + offset, &payload, sizeof(payload));
+        }
+    }
+
+    size_t getPageCount() const { return pageCount; }
+};
+
+template <typename T>
+void appendComponent(std::vector<uint8_t>& stream, ComponentType type, const T& payload,
+                     const void* extra = nullptr, size_t extraSize = 0) {
+    ComponentHeader header{};
+    header.type = type;
+    header.size = static_cast<uint32_t>(alignUp(sizeof(T) + extraSize, alignof(ComponentHeader)));
+
+    size_t offset = stream.size();
+    stream.resize(offset + sizeof(ComponentHeader) + header.size, 0);
+    std::memcpy(stream.data() + offset, &header, sizeof(header));
+    std::memcpy(stream.data() + offset + sizeof(header), &payload, sizeof(T));
+    if (extra)
+        std::memcpy(stream.data() + offset + sizeof(header) + sizeof(T), extra, extraSize);
+}
+
+bool compileMeshRenderer(std::vector<uint8_t>& stream, StringTable& strings, MeshBaker& meshes,
+                         const json& comp) {
+    MeshRendererComponentData compData{};
 
     std::string objPath = comp["mesh"]["path"];
     std::string vertPath = comp["material"]["vertexShaderPath"];
     std::string fragPath = comp["material"]["fragmentShaderPath"];
     std::array<float, 4> color = comp["material"]["color"];
 
-    compData.meshRenderer.mesh.shadeSmooth = comp["mesh"].value("shadeSmooth", true);
+    bool shadeSmooth = comp["mesh"].value("shadeSmooth", true);
+    if (!meshes.add(objPath, shadeSmooth, strings, compData.mesh.mesh))
+        return false;
 
-    std::snprintf(compData.meshRenderer.mesh.path, sizeof(compData.meshRenderer.mesh.path), "%s",
-                  objPath.c_str());
-    std::snprintf(compData.meshRenderer.material.vertexShaderPath,
-                  sizeof(compData.meshRenderer.material.vertexShaderPath), "%s", vertPath.c_str());
-    std::snprintf(compData.meshRenderer.material.fragmentShaderPath,
-                  sizeof(compData.meshRenderer.material.fragmentShaderPath), "%s",
-                  fragPath.c_str());
+    compData.material.vertexShaderPath = strings.add(vertPath);
+    compData.material.fragmentShaderPath = strings.add(fragPath);
 
-    compData.meshRenderer.material.color = {color[0], color[1], color[2], color[3]};
+    compData.material.color = {color[0], color[1], color[2], color[3]};
+
+    appendComponent(stream, ComponentType::MESH_RENDERER, compData);
+    return true;
 }
 
-void compileSpriteRenderer(ComponentData& compData, const json& comp) {
-    compData.type = ComponentType::SPRITE_RENDERER;
+bool compileSpriteRenderer(std::vector<uint8_t>& stream, StringTable& strings,
+                           SpriteAtlas& atlas, const json& comp) {
+    SpriteRendererComponentData compData{};
 
     std::string texPath = comp["texture"]["path"];
     float scaleFactor = comp["texture"].value("scaleFactor", 1.0f);
@@ -43,102 +909,109 @@ void compileSpriteRenderer(ComponentData& compData, const json& comp) {
     std::string fragPath = comp["material"]["fragmentShaderPath"];
     std::array<float, 4> color = comp["material"]["color"];
 
-    int width, height, channels;
-    if (!stbi_info(texPath.c_str(), &width, &height, &channels)) {
-        std::cerr << "Failed to read texture info: " << texPath << std::endl;
-        width = height = 1;
-    }
+    compData.texture.filterType = (filter == "LINEAR") ? 1 : 0;
+    uint32_t image;
+    if (!atlas.add(texPath, compData.texture.filterType, image))
+        return false;
 
-    std::snprintf(compData.spriteRenderer.texture.path,
-                  sizeof(compData.spriteRenderer.texture.path), "%s", texPath.c_str());
+    // Page and UV rect are filled in by SpriteAtlas::build
+    compData.texture.width = static_cast<float>(atlas.getWidth(image));
+    compData.texture.height = static_cast<float>(atlas.getHeight(image));
+    compData.texture.scaleFactor = scaleFactor;
 
-    compData.spriteRenderer.texture.width = static_cast<float>(width);
-    compData.spriteRenderer.texture.height = static_cast<float>(height);
-    compData.spriteRenderer.texture.scaleFactor = scaleFactor;
-    compData.spriteRenderer.texture.filterType = (filter == "LINEAR") ? 1 : 0;
+    compData.material.vertexShaderPath = strings.add(vertPath);
+    compData.material.fragmentShaderPath = strings.add(fragPath);
 
-    std::snprintf(compData.spriteRenderer.material.vertexShaderPath,
-                  sizeof(compData.spriteRenderer.material.vertexShaderPath), "%s",
-                  vertPath.c_str());
-    std::snprintf(compData.spriteRenderer.material.fragmentShaderPath,
-                  sizeof(compData.spriteRenderer.material.fragmentShaderPath), "%s",
-                  fragPath.c_str());
+    compData.material.color = {color[0], color[1], color[2], color[3]};
 
-    compData.spriteRenderer.material.color = {color[0], color[1], color[2], color[3]};
+    atlas.reference(stream.size() + sizeof(ComponentHeader), image);
+    appendComponent(stream, ComponentType::SPRITE_RENDERER, compData);
+    return true;
 }
 
-void compileCamera(ComponentData& compData, const json& comp) {
-    compData.type = ComponentType::CAMERA;
+void compileCamera(std::vector<uint8_t>& stream, StringTable& strings, TextureBaker& textures,
+                   const json& comp) {
+    CameraComponentData compData{};
+    SkyboxData skyboxData{};
 
     for (int i = 0; i < 4; i++)
-        compData.camera.background_color[i] = comp["background_color"][i];
+        compData.background_color[i] = comp["background_color"][i];
 
-    compData.camera.fov = comp["fov"];
+    compData.fov = comp["fov"];
 
     for (int i = 0; i < 2; i++)
-        compData.camera.view_rect[i] = comp["view_rect"][i];
+        compData.view_rect[i] = comp["view_rect"][i];
 
-    compData.camera.orthographic = comp.value("orthographic", false);
-    compData.camera.orthoSize = comp.value("orthoSize", 5.0f);
+    compData.orthographic = comp.value("orthographic", false);
+    compData.orthoSize = comp.value("orthoSize", 5.0f);
 
     if (comp.contains("skybox")) {
-        compData.camera.hasSkybox = true;
+        compData.hasSkybox = true;
         auto& skybox = comp["skybox"];
 
         std::string vertPath = skybox["material"]["vertexShaderPath"];
         std::string fragPath = skybox["material"]["fragmentShaderPath"];
 
-        std::snprintf(compData.camera.skybox.material.vertexShaderPath,
-                      sizeof(compData.camera.skybox.material.vertexShaderPath), "%s",
-                      vertPath.c_str());
-        std::snprintf(compData.camera.skybox.material.fragmentShaderPath,
-                      sizeof(compData.camera.skybox.material.fragmentShaderPath), "%s",
-                      fragPath.c_str());
+        skyboxData.material.vertexShaderPath = strings.add(vertPath);
+        skyboxData.material.fragmentShaderPath = strings.add(fragPath);
 
         for (int i = 0; i < 6; i++) {
             std::string texPath = skybox["cubeMapTextures"][i];
-            std::snprintf(compData.camera.skybox.cubeMapTextures[i],
-                          sizeof(compData.camera.skybox.cubeMapTextures[i]), "%s", texPath.c_str());
+            // Faces that fail to bake drop the skybox, as a missing face did at runtime
+            if (!textures.add(texPath, 1, strings, skyboxData.cubeMapTextures[i]))
+                compData.hasSkybox = false;
         }
     } else {
-        compData.camera.hasSkybox = false;
+        compData.hasSkybox = false;
     }
+
+    if (compData.hasSkybox)
+        appendComponent(stream, ComponentType::CAMERA, compData, &skyboxData, sizeof(skyboxData));
+    else
+        appendComponent(stream, ComponentType::CAMERA, compData);
 }
 
-void compileLight(ComponentData& compData, const json& comp) {
-    compData.type = ComponentType::LIGHT;
+void compileLight(std::vector<uint8_t>& stream, const json& comp) {
+    LightComponentData compData{};
 
     std::string lightType = comp["lightType"];
     if (lightType == "DIRECTIONAL")
-        compData.light.lightType = 0;
+        compData.lightType = 0;
     else if (lightType == "POINT")
-        compData.light.lightType = 1;
+        compData.lightType = 1;
     else if (lightType == "SPOT")
-        compData.light.lightType = 2;
+        compData.lightType = 2;
     else
-        compData.light.lightType = 0;
+        compData.lightType = 0;
 
-    compData.light.direction.x = comp["direction"][0];
-    compData.light.direction.y = comp["direction"][1];
-    compData.light.direction.z = comp["direction"][2];
+    compData.direction.x = comp["direction"][0];
+    compData.direction.y = comp["direction"][1];
+    compData.direction.z = comp["direction"][2];
 
-    compData.light.intensity = comp["intensity"];
+    compData.intensity = comp["intensity"];
+    compData.range = comp.value("range", 10.0f);
+    compData.innerConeAngle = comp.value("innerConeAngle", 30.0f);
+    compData.outerConeAngle = comp.value("outerConeAngle", 45.0f);
 
     for (int i = 0; i < 4; i++)
-        compData.light.color[i] = comp["color"][i];
+        compData.color[i] = comp["color"][i];
+
+    appendComponent(stream, ComponentType::LIGHT, compData);
 }
 
-void compileWorldObjects(CompiledScene& scene, const json& j) {
-    scene.worldObjectCount = 0;
+// Returns false when a mesh cannot be baked; the scene would otherwise load without it
+bool compileWorldObjects(std::vector<WorldObjectData>& objects, std::vector<uint8_t>& stream,
+                         StringTable& strings, MeshBaker& meshes, TextureBaker& textures,
+                         SpriteAtlas& atlas, const json& j) {
     if (!j.contains("worldObjects"))
-        return;
+        return true;
 
     auto& worldObjects = j["worldObjects"];
-    scene.worldObjectCount = worldObjects.size();
+    objects.resize(worldObjects.size());
 
-    for (size_t i = 0; i < worldObjects.size() && i < 32; i++) {
+    for (size_t i = 0; i < worldObjects.size(); i++) {
         auto& wo = worldObjects[i];
-        auto& woData = scene.worldObjects[i];
+        auto& woData = objects[i];
 
         // Transform (sempre presente)
         if (wo.contains("transform")) {
@@ -162,27 +1035,77 @@ void compileWorldObjects(CompiledScene& scene, const json& j) {
         }
 
         // Componentes
+        woData.componentOffset = static_cast<uint32_t>(stream.size());
         woData.componentCount = 0;
-        if (wo.contains("components")) {
-            auto& components = wo["components"];
-            woData.componentCount = components.size();
-
-            for (size_t j = 0; j < components.size() && j < 8; j++) {
-                auto& comp = components[j];
-                std::string type = comp["type"];
-
-                if (type == "MESH_RENDERER") {
-                    compileMeshRenderer(woData.components[j], comp);
-                } else if (type == "SPRITE_RENDERER") {
-                    compileSpriteRenderer(woData.components[j], comp);
-                } else if (type == "CAMERA") {
-                    compileCamera(woData.components[j], comp);
-                } else if (type == "LIGHT") {
-                    compileLight(woData.components[j], comp);
+        if (!wo.contains("components"))
+            continue;
+
+        for (auto& comp : wo["components"]) {
+            std::string type = comp["type"];
+
+            if (type == "MESH_RENDERER") {
+                if (!compileMeshRenderer(stream, strings, meshes, comp)) {
+                    std::cerr << "Failed to compile MESH_RENDERER of world object " << i
+                              << std::endl;
+                    return false;
                 }
+            } else if (type == "SPRITE_RENDERER") {
+                if (!compileSpriteRenderer(stream, strings, atlas, comp))
+                    continue;
+            } else if (type == "CAMERA") {
+                compileCamera(stream, strings, textures, comp);
+            } else if (type == "LIGHT") {
+                compileLight(stream, comp);
+            } else {
+                std::cerr << "Unknown component type: " << type << std::endl;
+                continue;
             }
+            woData.componentCount++;
         }
     }
+    return true;
+}
+
+struct SceneChunk {
+    SceneChunkType type;
+    const void* data;
+    size_t size;
+};
+
+bool writeScene(const char* path, const std::vector<SceneChunk>& chunks) {
+    SceneFileHeader header{};
+    header.magic = SCENE_MAGIC;
+    header.version = SCENE_FORMAT_VERSION;
+    header.chunkCount = static_cast<uint16_t>(chunks.size());
+
+    std::vector<SceneChunkEntry> directory(chunks.size());
+    size_t offset = alignUp(sizeof(SceneFileHeader) + directory.size() * sizeof(SceneChunkEntry),
+                            SCENE_CHUNK_ALIGNMENT);
+    for (size_t i = 0; i < chunks.size(); i++) {
+        directory[i].type = chunks[i].type;
+        directory[i].checksum = sceneChecksum(chunks[i].data, chunks[i].size);
+        directory[i].offset = offset;
+        directory[i].size = chunks[i].size;
+        offset = alignUp(offset + chunks[i].size, SCENE_CHUNK_ALIGNMENT);
+    }
+    header.fileSize = offset;
+    header.directoryChecksum =
+        sceneChecksum(directory.data(), directory.size() * sizeof(SceneChunkEntry));
+
+    std::vector<uint8_t> file(offset, 0);
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + sizeof(header), directory.data(),
+                directory.size() * sizeof(SceneChunkEntry));
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (chunks[i].size > 0)
+            std::memcpy(file.data() + directory[i].offset, chunks[i].data, chunks[i].size);
+    }
+
+    std::ofstream output(path, std::ios::binary);
+    if (!output.is_open())
+        return false;
+    output.write(reinterpret_cast<const char*>(file.data()), file.size());
+    return output.good();
 }
 
 int main(int argc, char* argv[]) {
@@ -199,14 +1122,37 @@ int main(int argc, char* argv[]) {
 
     json j = json::parse(input);
 
-    CompiledScene scene;
-    compileWorldObjects(scene, j);
+    std::vector<WorldObjectData> objects;
+    std::vector<uint8_t> componentStream;
+    StringTable strings;
+    MeshBaker meshes;
+    TextureBaker textures;
+    SpriteAtlas atlas;
+    if (!compileWorldObjects(objects, componentStream, strings, meshes, textures, atlas, j)) {
+        std::cerr << "Failed to compile scene: " << argv[1] << std::endl;
+        return 1;
+    }
+    atlas.build(textures, strings, componentStream);
+    std::vector<uint8_t> stringChunk = strings.serialize();
+    std::vector<uint8_t> meshChunk = meshes.serialize();
+    std::vector<uint8_t> textureChunk = textures.serialize();
+
+    std::vector<SceneChunk> chunks = {
+        {SceneChunkType::OBJECTS, objects.data(), objects.size() * sizeof(WorldObjectData)},
+        {SceneChunkType::COMPONENTS, componentStream.data(), componentStream.size()},
+        {SceneChunkType::STRINGS, stringChunk.data(), stringChunk.size()},
+        {SceneChunkType::MESHES, meshChunk.data(), meshChunk.size()},
+        {SceneChunkType::TEXTURES, textureChunk.data(), textureChunk.size()}};
 
-    std::ofstream output(argv[2], std::ios::binary);
-    output.write(reinterpret_cast<char*>(&scene), sizeof(CompiledScene));
+    if (!writeScene(argv[2], chunks)) {
+        std::cerr << "Failed to write output file: " << argv[2] << std::endl;
+        return 1;
+    }
 
-    std::cout << "Scene compiled successfully: " << scene.worldObjectCount << " world objects"
-              << std::endl;
+    std::cout << "Scene compiled successfully: " << objects.size() << " world objects, "
+              << meshes.size() << " baked meshes, " << textures.size() << " baked textures ("
+              << atlas.getPageCount() << " sprite atlas pages), " << strings.size()
+              << " unique paths" << std::endl;
 
     return 0;
 }
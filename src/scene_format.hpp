@@ -3,49 +3,139 @@
 
 #include "color.hpp"
 #include "vector3.hpp"
+#include <cstddef>
 #include <cstdint>
 
-struct LightData {
-    uint8_t type; // 0=DIRECTIONAL, 1=POINT, 2=SPOT
-    Vector3 direction;
-    float color[4];
-    float intensity;
-    // float position[3];
+// .scnb layout (version 9):
+//
+//   SceneFileHeader
+//   SceneChunkEntry[chunkCount]
+//   chunks (each one aligned to SCENE_CHUNK_ALIGNMENT)
+//
+// OBJECTS is a table of WorldObjectData. COMPONENTS is a packed stream of
+// ComponentHeader + payload records, referenced by the objects through byte offsets.
+// STRINGS holds every asset path once: a uint32 count, count uint32 offsets into the
+// character data, then the null-terminated strings. Records refer to paths by index.
+// MESHES holds every referenced OBJ baked offline: a MeshChunkHeader, the BakedMeshData
+// table, then welded vertices interleaved as float3 position + float3 normal and 16/32-bit
+// triangle indices, ready to be uploaded as-is.
+// TEXTURES holds every referenced image decoded offline with its mip chain already built
+// and block compressed: a TextureChunkHeader, the BakedTextureData table, the
+// BakedTextureLevel table, then the level data. Sprite images are packed into shared
+// atlas pages, which are stored as ordinary textures.
+
+inline constexpr uint32_t makeSceneFourCC(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+           (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+inline constexpr uint32_t SCENE_MAGIC = 0x53434E45;
+inline constexpr uint16_t SCENE_FORMAT_VERSION = 9;
+inline constexpr uint32_t SCENE_CHUNK_ALIGNMENT = 16;
+inline constexpr uint32_t SCENE_INVALID_STRING = 0xFFFFFFFF;
+
+enum class SceneChunkType : uint32_t {
+    OBJECTS = makeSceneFourCC('O', 'B', 'J', 'S'),
+    COMPONENTS = makeSceneFourCC('C', 'O', 'M', 'P'),
+    STRINGS = makeSceneFourCC('S', 'T', 'R', 'S'),
+    MESHES = makeSceneFourCC('M', 'E', 'S', 'H'),
+    TEXTURES = makeSceneFourCC('T', 'E', 'X', 'S')
+};
+
+struct SceneFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t chunkCount;
+    uint64_t fileSize;
+    uint32_t directoryChecksum; // checksum of the chunk directory
+    uint32_t reserved;
+};
+
+struct SceneChunkEntry {
+    SceneChunkType type;
+    uint32_t checksum; // checksum of the chunk contents
+    uint64_t offset;   // from the start of the file
+    uint64_t size;
 };
 
+// FNV-1a, shared by the compiler and the loader
+inline uint32_t sceneChecksum(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Path fields are indices into the STRINGS chunk
 struct MaterialData {
-    char vertexShaderPath[256];
-    char fragmentShaderPath[256];
+    uint32_t vertexShaderPath;
+    uint32_t fragmentShaderPath;
     ColorRGBA color;
 };
 
 struct TextureData {
-    char path[256];
-    float width;
+    uint32_t texture; // index into the TEXTURES table, usually an atlas page
+    float width;      // of the source image, in pixels
     float height;
     float scaleFactor;
     uint8_t filterType; // 0=NEAREST, 1=LINEAR
+    float uvRect[4];    // u0, v0, u1, v1 of the image inside the texture
 };
 
 struct MeshData {
-    char path[256];
-    bool shadeSmooth;
+    uint32_t mesh; // index into the MESHES table
+};
+
+struct MeshChunkHeader {
+    uint32_t meshCount;
+    uint32_t reserved[3];
+};
+
+// Indexed triangle list, one normal per vertex (already smooth or flat according to
+// shadeSmooth); vertices sharing both position and normal are welded
+struct BakedMeshData {
+    uint32_t path;
+    uint8_t shadeSmooth;
+    uint8_t indexType; // IndexType
+    uint8_t reserved[2];
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t vertexStride; // bytes per interleaved vertex
+    float boundsMin[3];
+    float boundsMax[3];
+    uint64_t verticesOffset; // from the start of the MESHES chunk, vertexCount * vertexStride
+    uint64_t indicesOffset;  // from the start of the MESHES chunk, indexCount * index size
 };
 
 struct SkyboxData {
-    char cubeMapTextures[6][256];
+    uint32_t cubeMapTextures[6]; // indices into the TEXTURES table
     MaterialData material;
 };
 
-struct SceneCameraData {
-    float background_color[4];
-    float fov;
-    float view_rect[2];
-    double position[3];
-    bool orthographic;
-    float orthoSize;
-    bool hasSkybox;
-    SkyboxData skybox;
+struct TextureChunkHeader {
+    uint32_t textureCount;
+    uint32_t levelCount; // total entries in the level table
+    uint32_t reserved[2];
+};
+
+struct BakedTextureData {
+    uint32_t path;
+    uint8_t format; // TextureFormat
+    uint8_t filterType;
+    uint8_t levelCount;
+    uint8_t reserved;
+    uint32_t firstLevel; // index into the level table
+    uint32_t reserved2;
+};
+
+struct BakedTextureLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset; // from the start of the TEXTURES chunk
+    uint64_t size;
 };
 
 enum class ComponentType : uint8_t {
@@ -56,6 +146,17 @@ enum class ComponentType : uint8_t {
     LIGHT = 4
 };
 
+struct MeshRendererComponentData {
+    MeshData mesh;
+    MaterialData material;
+};
+
+struct SpriteRendererComponentData {
+    MaterialData material;
+    TextureData texture;
+};
+
+// When hasSkybox is set, a SkyboxData immediately follows in the payload
 struct CameraComponentData {
     float background_color[4];
     float fov;
@@ -63,7 +164,6 @@ struct CameraComponentData {
     bool orthographic;
     float orthoSize;
     bool hasSkybox;
-    SkyboxData skybox;
 };
 
 struct LightComponentData {
@@ -71,44 +171,23 @@ struct LightComponentData {
     Vector3 direction;
     float color[4];
     float intensity;
+    float range;          // POINT and SPOT; the light fades to zero at this distance
+    float innerConeAngle; // SPOT, half angles in degrees
+    float outerConeAngle;
 };
 
-struct ComponentData {
+struct ComponentHeader {
     ComponentType type;
-    union {
-        struct {
-            Vector3 position;
-            Vector3 rotation;
-            Vector3 scale;
-        } transform;
-
-        struct {
-            MeshData mesh;
-            MaterialData material;
-        } meshRenderer;
-
-        struct {
-            MaterialData material;
-            TextureData texture;
-        } spriteRenderer;
-
-        CameraComponentData camera;
-        LightComponentData light;
-    };
+    uint8_t reserved[3];
+    uint32_t size; // payload size, header excluded
 };
 
 struct WorldObjectData {
     Vector3 position;
     Vector3 rotation;
     Vector3 scale;
-    uint8_t componentCount;
-    ComponentData components[8];
-};
-
-struct CompiledScene {
-    uint32_t magic = 0x53434E45;
-    uint32_t worldObjectCount;
-    WorldObjectData worldObjects[32];
+    uint32_t componentOffset; // offset of the first component inside COMPONENTS
+    uint32_t componentCount;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,9 +1,6 @@
 #define CLASS_NAME "SceneLoader"
 #include "log_macros.hpp"
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tinyobjloader/tiny_obj_loader.h"
-
 #include "components/camera.hpp"
 #include "components/light.hpp"
 #include "components/mesh_renderer.hpp"
@@ -14,61 +11,76 @@
 #include "scene_loader.hpp"
 #include "shader_asset.hpp"
 #include "skybox.hpp"
-#include "stb_image.h"
-#include <fstream>
 
 SceneLoader::SceneLoader() : rendererBackend(nullptr) {}
 
 void SceneLoader::setRendererBackend(RendererBackend& backend) { rendererBackend = &backend; }
 
-CompiledScene* SceneLoader::loadCompiledScene(const std::string& filepath) {
-    if (!validateSceneFile(filepath))
-        return nullptr;
+bool SceneLoader::loadCompiledScene(const std::string& filepath, CompiledScene& scene) {
+    if (!scene.open(filepath))
+        return false;
 
-    std::ifstream file(filepath, std::ios::binary);
-    auto scene = new CompiledScene();
-    if (!file.read(reinterpret_cast<char*>(scene), sizeof(CompiledScene))) {
-        LOG_ERROR("Failed to read scene file: " + filepath);
-        delete scene;
-        return nullptr;
-    }
+    LOG_INFO("Loaded scene with " + std::to_string(scene.getWorldObjectCount()) +
+             " world objects");
+    return true;
+}
 
-    LOG_INFO("Loaded scene with " + std::to_string(scene->worldObjectCount) + " world objects");
-    return scene;
+void SceneLoader::internScenePaths(const CompiledScene& scene) {
+    scenePathIds.resize(scene.getStringCount());
+    for (uint32_t i = 0; i < scene.getStringCount(); i++)
+        scenePathIds[i] = pathTable.intern(scene.getString(i));
 }
 
-void SceneLoader::loadMeshRendererComponent(WorldObject* obj, const ComponentData& comp) {
-    auto& meshData = comp.meshRenderer.mesh;
-    auto& materialData = comp.meshRenderer.material;
+PathId SceneLoader::getScenePathId(uint32_t stringIndex) const {
+    return stringIndex < scenePathIds.size() ? scenePathIds[stringIndex] : INVALID_PATH_ID;
+}
 
-    auto mesh = loadObjMesh(meshData.path, meshData.shadeSmooth);
-    if (!mesh) {
-        LOG_ERROR("Failed to load mesh: " + std::string(meshData.path));
+const std::string& SceneLoader::getScenePath(uint32_t stringIndex) const {
+    return pathTable.getPath(getScenePathId(stringIndex));
+}
+
+unsigned int SceneLoader::acquireTexture(const CompiledScene& scene, uint32_t index,
+                                         uint8_t filterType) {
+    if (index >= sceneTextures.size())
+        return 0;
+    if (sceneTextures[index])
+        return sceneTextures[index];
+
+    TextureImage image;
+    if (!scene.getTextureImage(index, image))
+        return 0;
+
+    sceneTextures[index] = rendererBackend->loadTexture(image, filterType);
+    return sceneTextures[index];
+}
+
+void SceneLoader::loadMeshRendererComponent(WorldObject* obj, const CompiledScene& scene,
+                                            const MeshRendererComponentData& comp) {
+    auto& materialData = comp.material;
+
+    auto meshData = scene.getMesh(comp.mesh.mesh);
+    if (!meshData) {
+        LOG_ERROR("Invalid baked mesh #" + std::to_string(comp.mesh.mesh));
         return;
     }
-    mesh->setMeshBuffer(rendererBackend->createMeshBuffer());
-    mesh->configure();
 
-    auto shaderExt = rendererBackend->getShaderExtension();
-    auto vertexShader = std::make_unique<ShaderAsset>(materialData.vertexShaderPath + shaderExt,
-                                                      ShaderType::VERTEX);
-    vertexShader->setShaderCompiler(rendererBackend->createShaderCompiler());
+    const auto& meshPath = getScenePath(meshData->path);
+    auto mesh = acquireMesh(scene, *meshData);
+    if (!mesh) {
+        LOG_ERROR("Failed to load mesh: " + meshPath);
+        return;
+    }
 
-    auto fragmentShader = std::make_unique<ShaderAsset>(materialData.fragmentShaderPath + shaderExt,
-                                                        ShaderType::FRAGMENT);
-    fragmentShader->setShaderCompiler(rendererBackend->createShaderCompiler());
+    auto program = acquireShaderProgram(materialData, mesh->getVertexLayout());
+    if (!program) {
+        LOG_ERROR("Material init failed for mesh: " + meshPath);
+        return;
+    }
 
     auto material = std::make_unique<Material>();
-    material->setShaderProgram(rendererBackend->createShaderProgram());
-    material->setVertexShader(std::move(vertexShader));
-    material->setFragmentShader(std::move(fragmentShader));
+    material->setShaderProgram(std::move(program));
     material->setBaseColor(materialData.color);
 
-    if (!material->init()) {
-        LOG_ERROR("Material init failed for mesh: " + std::string(meshData.path));
-        return;
-    }
-
     auto meshRenderer = std::make_unique<MeshRenderer>();
     meshRenderer->setMaterial(std::move(material));
 
@@ -76,37 +88,38 @@ void SceneLoader::loadMeshRendererComponent(WorldObject* obj, const ComponentDat
     obj->addComponent(std::move(meshRenderer));
 }
 
-void SceneLoader::loadSpriteRendererComponent(WorldObject* obj, const ComponentData& comp) {
-    auto& textureData = comp.spriteRenderer.texture;
-    auto& materialData = comp.spriteRenderer.material;
+void SceneLoader::loadSpriteRendererComponent(WorldObject* obj, const CompiledScene& scene,
+                                              const SpriteRendererComponentData& comp) {
+    auto& textureData = comp.texture;
+    auto& materialData = comp.material;
 
     float width = textureData.width * textureData.scaleFactor;
     float height = textureData.height * textureData.scaleFactor;
     auto sprite = std::make_unique<Sprite>(width, height);
 
-    unsigned int texID = rendererBackend->loadTexture(textureData.path, textureData.filterType);
-    sprite->setTexture(texID);
+    auto bakedTexture = scene.getTexture(textureData.texture);
+    unsigned int texID =
+        bakedTexture ? acquireTexture(scene, textureData.texture, textureData.filterType) : 0;
+    if (!texID) {
+        LOG_ERROR("Invalid baked texture #" + std::to_string(textureData.texture));
+        return;
+    }
 
-    auto shaderExt = rendererBackend->getShaderExtension();
-    auto vertexShader = std::make_unique<ShaderAsset>(materialData.vertexShaderPath + shaderExt,
-                                                      ShaderType::VERTEX);
-    vertexShader->setShaderCompiler(rendererBackend->createShaderCompiler());
+    const auto& texturePath = getScenePath(bakedTexture->path);
+    sprite->setTexture(texID);
+    sprite->setUVRect(textureData.uvRect[0], textureData.uvRect[1], textureData.uvRect[2],
+                      textureData.uvRect[3]);
 
-    auto fragmentShader = std::make_unique<ShaderAsset>(materialData.fragmentShaderPath + shaderExt,
-                                                        ShaderType::FRAGMENT);
-    fragmentShader->setShaderCompiler(rendererBackend->createShaderCompiler());
+    auto program = acquireShaderProgram(materialData, VertexLayout::positionTexcoord());
+    if (!program) {
+        LOG_ERROR("Material init failed for sprite: " + texturePath);
+        return;
+    }
 
     auto material = std::make_unique<Material>();
-    material->setShaderProgram(rendererBackend->createShaderProgram());
-    material->setVertexShader(std::move(vertexShader));
-    material->setFragmentShader(std::move(fragmentShader));
+    material->setShaderProgram(std::move(program));
     material->setBaseColor(materialData.color);
 
-    if (!material->init()) {
-        LOG_ERROR("Material init failed for sprite: " + std::string(textureData.path));
-        return;
-    }
-
     auto spriteRenderer = std::make_unique<SpriteRenderer>();
     spriteRenderer->setMaterial(std::move(material));
 
@@ -114,8 +127,32 @@ void SceneLoader::loadSpriteRendererComponent(WorldObject* obj, const ComponentD
     obj->addComponent(std::move(spriteRenderer));
 }
 
-void SceneLoader::loadCameraComponent(WorldObject* obj, const ComponentData& comp) {
-    auto& camData = comp.camera;
+std::unique_ptr<Skybox> SceneLoader::loadSkybox(const CompiledScene& scene,
+                                                const SkyboxData& skyboxData) {
+    std::array<TextureImage, 6> faces;
+    for (size_t i = 0; i < faces.size(); i++) {
+        if (!scene.getTextureImage(skyboxData.cubeMapTextures[i], faces[i])) {
+            LOG_ERROR("Invalid baked texture for cubemap face #" + std::to_string(i));
+            return nullptr;
+        }
+    }
+
+    auto skybox = std::make_unique<Skybox>();
+
+    auto skyboxMaterial = std::make_unique<Material>();
+    skyboxMaterial->setShaderProgram(
+        acquireShaderProgram(skyboxData.material, VertexLayout::position()));
+
+    unsigned int cubemapID = rendererBackend->createCubemapTexture(faces);
+    skybox->setTextureID(cubemapID);
+    skybox->setMaterial(std::move(skyboxMaterial));
+    skybox->init();
+    return skybox;
+}
+
+void SceneLoader::loadCameraComponent(WorldObject* obj, const CompiledScene& scene,
+                                      const CameraComponentData& camData,
+                                      const SkyboxData* skyboxData) {
 
     auto camera = std::make_unique<Camera>();
     camera->setBackgroundColor(ColorRGBA{camData.background_color[0], camData.background_color[1],
@@ -125,41 +162,15 @@ void SceneLoader::loadCameraComponent(WorldObject* obj, const ComponentData& com
     camera->setOrthographic(camData.orthographic);
     camera->setOrthoSize(camData.orthoSize);
 
-    if (camData.hasSkybox) {
-        auto skybox = std::make_unique<Skybox>();
-
-        auto shaderExt = rendererBackend->getShaderExtension();
-        auto skyboxVertexShaderPtr = std::make_unique<ShaderAsset>(
-            camData.skybox.material.vertexShaderPath + shaderExt, ShaderType::VERTEX);
-        skyboxVertexShaderPtr->setShaderCompiler(rendererBackend->createShaderCompiler());
-
-        auto skyboxFragmentShaderPtr = std::make_unique<ShaderAsset>(
-            camData.skybox.material.fragmentShaderPath + shaderExt, ShaderType::FRAGMENT);
-        skyboxFragmentShaderPtr->setShaderCompiler(rendererBackend->createShaderCompiler());
-
-        auto skyboxMaterial = std::make_unique<Material>();
-        skyboxMaterial->setShaderProgram(rendererBackend->createShaderProgram());
-        skyboxMaterial->setVertexShader(std::move(skyboxVertexShaderPtr));
-        skyboxMaterial->setFragmentShader(std::move(skyboxFragmentShaderPtr));
-        skyboxMaterial->init();
-
-        std::vector<std::string> faces;
-        for (const auto& row : camData.skybox.cubeMapTextures) {
-            faces.push_back(row);
-        }
-
-        unsigned int cubemapID = rendererBackend->createCubemapTexture(faces);
-        skybox->setTextureID(cubemapID);
-        skybox->setMaterial(std::move(skyboxMaterial));
-        skybox->init();
-        camera->setSkybox(std::move(skybox));
+    if (skyboxData) {
+        if (auto skybox = loadSkybox(scene, *skyboxData))
+            camera->setSkybox(std::move(skybox));
     }
 
     obj->addComponent(std::move(camera));
 }
 
-void SceneLoader::loadLightComponent(WorldObject* obj, const ComponentData& comp) {
-    auto& lightData = comp.light;
+void SceneLoader::loadLightComponent(WorldObject* obj, const LightComponentData& lightData) {
 
     auto light = std::make_unique<Light>();
     light->setType(static_cast<LightType>(lightData.lightType));
@@ -167,93 +178,117 @@ void SceneLoader::loadLightComponent(WorldObject* obj, const ComponentData& comp
     light->setColor(
         ColorRGBA{lightData.color[0], lightData.color[1], lightData.color[2], lightData.color[3]});
     light->setIntensity(lightData.intensity);
+    light->setRange(lightData.range);
+    light->setConeAngles(lightData.innerConeAngle, lightData.outerConeAngle);
 
     obj->addComponent(std::move(light));
 }
 
-std::unique_ptr<Mesh> SceneLoader::loadObjMesh(const std::string& filepath, bool shadeSmooth) {
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
-
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, filepath.c_str())) {
-        LOG_ERROR("Unable to load obj: " + filepath);
+std::unique_ptr<Mesh> SceneLoader::loadBakedMesh(const CompiledScene& scene,
+                                                const BakedMeshData& meshData) {
+    auto mesh = std::make_unique<Mesh>();
+    mesh->setMeshBuffer(rendererBackend->createMeshBuffer());
+    MeshBufferDesc desc;
+    desc.vertices = scene.getMeshVertices(meshData);
+    desc.vertexCount = meshData.vertexCount;
+    desc.layout = VertexLayout::positionNormal();
+    desc.indices = scene.getMeshIndices(meshData);
+    desc.indexCount = meshData.indexCount;
+    desc.indexType = static_cast<IndexType>(meshData.indexType);
+    if (!mesh->configure(desc))
         return nullptr;
-    }
 
-    std::vector<float> vertices;
-    std::vector<float> normals;
-
-    if (shadeSmooth && !attrib.normals.empty()) {
-        for (const auto& shape : shapes) {
-            for (const auto& index : shape.mesh.indices) {
-                vertices.push_back(attrib.vertices[3 * index.vertex_index + 0]);
-                vertices.push_back(attrib.vertices[3 * index.vertex_index + 1]);
-                vertices.push_back(attrib.vertices[3 * index.vertex_index + 2]);
-
-                if (index.normal_index >= 0) {
-                    normals.push_back(attrib.normals[3 * index.normal_index + 0]);
-                    normals.push_back(attrib.normals[3 * index.normal_index + 1]);
-                    normals.push_back(attrib.normals[3 * index.normal_index + 2]);
-                }
-            }
-        }
-    } else {
-        for (const auto& shape : shapes) {
-            for (size_t f = 0; f < shape.mesh.indices.size(); f += 3) {
-                auto& i0 = shape.mesh.indices[f + 0];
-                auto& i1 = shape.mesh.indices[f + 1];
-                auto& i2 = shape.mesh.indices[f + 2];
-
-                float v0[3] = {attrib.vertices[3 * i0.vertex_index + 0],
-                               attrib.vertices[3 * i0.vertex_index + 1],
-                               attrib.vertices[3 * i0.vertex_index + 2]};
-                float v1[3] = {attrib.vertices[3 * i1.vertex_index + 0],
-                               attrib.vertices[3 * i1.vertex_index + 1],
-                               attrib.vertices[3 * i1.vertex_index + 2]};
-                float v2[3] = {attrib.vertices[3 * i2.vertex_index + 0],
-                               attrib.vertices[3 * i2.vertex_index + 1],
-                               attrib.vertices[3 * i2.vertex_index + 2]};
-
-                float edge1[3] = {v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2]};
-                float edge2[3] = {v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2]};
-                float normal[3] = {edge1[1] * edge2[2] - edge1[2] * edge2[1],
-                                   edge1[2] * edge2[0] - edge1[0] * edge2[2],
-                                   edge1[0] * edge2[1] - edge1[1] * edge2[0]};
-
-                float len =
-                    sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
-                if (len > 0) {
-                    normal[0] /= len;
-                    normal[1] /= len;
-                    normal[2] /= len;
-                }
-
-                for (int i = 0; i < 3; i++) {
-                    auto& idx = shape.mesh.indices[f + i];
-                    vertices.push_back(attrib.vertices[3 * idx.vertex_index + 0]);
-                    vertices.push_back(attrib.vertices[3 * idx.vertex_index + 1]);
-                    vertices.push_back(attrib.vertices[3 * idx.vertex_index + 2]);
-                    normals.push_back(normal[0]);
-                    normals.push_back(normal[1]);
-                    normals.push_back(normal[2]);
-                }
-            }
-        }
+    Bounds bounds;
+    for (int axis = 0; axis < 3; axis++) {
+        bounds.min.v[axis] = meshData.boundsMin[axis];
+        bounds.max.v[axis] = meshData.boundsMax[axis];
     }
+    mesh->setBounds(bounds);
+    return mesh;
+}
 
-    auto mesh = std::make_unique<Mesh>();
-    mesh->setVertices(vertices);
-    mesh->setNormals(normals);
+std::shared_ptr<ShaderProgram> SceneLoader::acquireShaderProgram(const MaterialData& materialData,
+                                                                const VertexLayout& layout) {
+    PathId vertexPath = getScenePathId(materialData.vertexShaderPath);
+    PathId fragmentPath = getScenePathId(materialData.fragmentShaderPath);
+    GraphicsAPI api = rendererBackend->getGraphicsAPI();
+    if (auto program = programCache.find(vertexPath, fragmentPath, api, layout))
+        return program;
+
+    // The shader objects are only needed until the program is linked
+    auto shaderExt = rendererBackend->getShaderExtension();
+    ShaderAsset vertexShader(pathTable.getPath(vertexPath) + shaderExt, ShaderType::VERTEX);
+    vertexShader.setShaderCompiler(rendererBackend->createShaderCompiler());
+    ShaderAsset fragmentShader(pathTable.getPath(fragmentPath) + shaderExt, ShaderType::FRAGMENT);
+    fragmentShader.setShaderCompiler(rendererBackend->createShaderCompiler());
+    if (!vertexShader.load() || !fragmentShader.load())
+        return nullptr;
+
+    std::shared_ptr<ShaderProgram> program = rendererBackend->createShaderProgram();
+    program->setVertexLayout(layout);
+    if (!program->attachShader(vertexShader) || !program->attachShader(fragmentShader) ||
+        !program->link())
+        return nullptr;
+
+    programCache.insert(vertexPath, fragmentPath, api, layout, program);
+    return program;
+}
+
+std::shared_ptr<Mesh> SceneLoader::acquireMesh(const CompiledScene& scene,
+                                              const BakedMeshData& meshData) {
+    PathId path = getScenePathId(meshData.path);
+    bool shadeSmooth = meshData.shadeSmooth != 0;
+    if (auto mesh = meshCache.find(path, shadeSmooth))
+        return mesh;
+
+    std::shared_ptr<Mesh> mesh = loadBakedMesh(scene, meshData);
+    if (mesh)
+        meshCache.insert(path, shadeSmooth, mesh);
     return mesh;
 }
 
-void SceneLoader::loadWorldObjects(WorldObjectManager* manager, const CompiledScene* scene) {
-    LOG_INFO("Loading " + std::to_string(scene->worldObjectCount) + " world objects");
+void SceneLoader::loadComponent(WorldObject* obj, const CompiledScene& scene,
+                                const ComponentHeader& comp) {
+    switch (comp.type) {
+    case ComponentType::MESH_RENDERER:
+        LOG_INFO("  - Loading MESH_RENDERER component");
+        if (auto data = getComponentPayload<MeshRendererComponentData>(comp))
+            loadMeshRendererComponent(obj, scene, *data);
+        break;
+    case ComponentType::SPRITE_RENDERER:
+        LOG_INFO("  - Loading SPRITE_RENDERER component");
+        if (auto data = getComponentPayload<SpriteRendererComponentData>(comp))
+            loadSpriteRendererComponent(obj, scene, *data);
+        break;
+    case ComponentType::CAMERA:
+        LOG_INFO("  - Loading CAMERA component");
+        if (auto data = getComponentPayload<CameraComponentData>(comp)) {
+            const SkyboxData* skybox = nullptr;
+            if (data->hasSkybox && comp.size >= sizeof(CameraComponentData) + sizeof(SkyboxData))
+                skybox = reinterpret_cast<const SkyboxData*>(data + 1);
+            loadCameraComponent(obj, scene, *data, skybox);
+        }
+        break;
+    case ComponentType::LIGHT:
+        LOG_INFO("  - Loading LIGHT component");
+        if (auto data = getComponentPayload<LightComponentData>(comp))
+            loadLightComponent(obj, *data);
+        break;
+    default:
+        break;
+    }
+}
+
+void SceneLoader::loadWorldObjects(WorldObjectManager* manager, const CompiledScene& scene) {
+    LOG_INFO("Loading " + std::to_string(scene.getWorldObjectCount()) + " world objects");
+
+    internScenePaths(scene);
+    meshCache.purge();
+    programCache.purge();
+    sceneTextures.assign(scene.getTextureCount(), 0);
 
-    for (uint32_t i = 0; i < scene->worldObjectCount; i++) {
-        auto& woData = scene->worldObjects[i];
+    for (uint32_t i = 0; i < scene.getWorldObjectCount(); i++) {
+        auto& woData = scene.getWorldObject(i);
         auto* obj = manager->createObject();
 
         // Carregar transform
@@ -266,38 +301,20 @@ void SceneLoader::loadWorldObjects(WorldObjectManager* manager, const CompiledSc
                  ", " + std::to_string(woData.position.z) + ")");
 
         // Carregar componentes
-        for (uint8_t j = 0; j < woData.componentCount; j++) {
-            auto& comp = woData.components[j];
-
-            switch (comp.type) {
-            case ComponentType::MESH_RENDERER:
-                LOG_INFO("  - Loading MESH_RENDERER component");
-                loadMeshRendererComponent(obj, comp);
-                break;
-            case ComponentType::SPRITE_RENDERER:
-                LOG_INFO("  - Loading SPRITE_RENDERER component");
-                loadSpriteRendererComponent(obj, comp);
-                break;
-            case ComponentType::CAMERA:
-                LOG_INFO("  - Loading CAMERA component");
-                loadCameraComponent(obj, comp);
-                break;
-            case ComponentType::LIGHT:
-                LOG_INFO("  - Loading LIGHT component");
-                loadLightComponent(obj, comp);
-                break;
-            default:
+        uint32_t offset = woData.componentOffset;
+        for (uint32_t j = 0; j < woData.componentCount; j++) {
+            auto comp = scene.getComponent(offset);
+            if (!comp) {
+                LOG_ERROR("Component #" + std::to_string(j) + " of WorldObject #" +
+                          std::to_string(i) + " is out of bounds");
                 break;
             }
+
+            loadComponent(obj, scene, *comp);
+            offset += sizeof(ComponentHeader) + comp->size;
         }
     }
-}
 
-bool SceneLoader::validateSceneFile(const std::string& filepath) {
-    std::ifstream file(filepath, std::ios::binary);
-    if (!file.good()) {
-        LOG_ERROR("Scene file does not exist: " + filepath);
-        return false;
-    }
-    return true;
+    LOG_INFO(std::to_string(meshCache.size()) + " unique meshes, " +
+             std::to_string(programCache.size()) + " shader programs resident");
 }
@@ -5,32 +5,65 @@
 #include "components/light.hpp"
 #include "components/mesh_renderer.hpp"
 #include "components/sprite_renderer.hpp"
+#include "compiled_scene.hpp"
 #include "mesh.hpp"
+#include "mesh_cache.hpp"
+#include "path_table.hpp"
 #include "renderer/renderer_backend.hpp"
 #include "scene_format.hpp"
+#include "shader_program_cache.hpp"
+#include "skybox.hpp"
 #include "world_object.hpp"
 #include "world_object_manager.hpp"
 #include <memory>
 #include <string>
+#include <vector>
 
 
 class SceneLoader {
   private:
     RendererBackend* rendererBackend = nullptr;
+    PathTable pathTable;
+    // Scene string index -> PathId, rebuilt for every loaded scene
+    std::vector<PathId> scenePathIds;
+    MeshCache meshCache;
+    ShaderProgramCache programCache;
+    // Scene texture index -> backend texture id (0 until first use), so sprites sharing an
+    // atlas page upload it once
+    std::vector<unsigned int> sceneTextures;
 
-    std::unique_ptr<Mesh> loadObjMesh(const std::string& filepath, bool shadeSmooth);
-    void loadMeshRendererComponent(WorldObject* obj, const ComponentData& comp);
-    void loadSpriteRendererComponent(WorldObject* obj, const ComponentData& comp);
-    void loadCameraComponent(WorldObject* obj, const ComponentData& comp); // ADICIONAR
-    void loadLightComponent(WorldObject* obj, const ComponentData& comp);  // ADICIONAR
+    void internScenePaths(const CompiledScene& scene);
+    PathId getScenePathId(uint32_t stringIndex) const;
+    const std::string& getScenePath(uint32_t stringIndex) const;
+
+    std::unique_ptr<Mesh> loadBakedMesh(const CompiledScene& scene, const BakedMeshData& meshData);
+    // Returns the resident mesh for (path, shadeSmooth), uploading it on first use
+    std::shared_ptr<Mesh> acquireMesh(const CompiledScene& scene, const BakedMeshData& meshData);
+    // Returns the backend texture for a scene texture, uploading it on first use; 0 on error
+    unsigned int acquireTexture(const CompiledScene& scene, uint32_t index, uint8_t filterType);
+    // Returns the linked program for the material's shaders, compiling it on first use
+    std::shared_ptr<ShaderProgram> acquireShaderProgram(const MaterialData& materialData,
+                                                        const VertexLayout& layout);
+    void loadMeshRendererComponent(WorldObject* obj, const CompiledScene& scene,
+                                   const MeshRendererComponentData& comp);
+    void loadSpriteRendererComponent(WorldObject* obj, const CompiledScene& scene,
+                                     const SpriteRendererComponentData& comp);
+    std::unique_ptr<Skybox> loadSkybox(const CompiledScene& scene, const SkyboxData& skyboxData);
+    void loadCameraComponent(WorldObject* obj, const CompiledScene& scene,
+                             const CameraComponentData& comp, const SkyboxData* skybox);
+    void loadLightComponent(WorldObject* obj, const LightComponentData& comp);
+    void loadComponent(WorldObject* obj, const CompiledScene& scene, const ComponentHeader& comp);
 
   public:
     SceneLoader();
     void setRendererBackend(RendererBackend&);
-    bool validateSceneFile(const std::string& filepath);
-    CompiledScene* loadCompiledScene(const std::string& filepath);
+    bool loadCompiledScene(const std::string& filepath, CompiledScene& scene);
+
+    void loadWorldObjects(WorldObjectManager* manager, const CompiledScene& scene);
 
-    void loadWorldObjects(WorldObjectManager* manager, const CompiledScene* scene);
+    const PathTable& getPathTable() const { return pathTable; }
+    const MeshCache& getMeshCache() const { return meshCache; }
+    const ShaderProgramCache& getProgramCache() const { return programCache; }
 };
 
 #endif
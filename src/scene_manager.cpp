@@ -19,24 +19,24 @@ void SceneManager::loadScene(const std::string& name) {
     }
 
     activeSceneName = name;
-    activeScene = std::make_unique<Scene>();
+    // The previous scene stays alive until the new one is loaded, so meshes both scenes
+    // share are picked up from the mesh cache instead of being uploaded again
+    auto scene = std::make_unique<Scene>();
 
-    auto compiledScene = sceneLoader.loadCompiledScene(it->second);
-    if (!compiledScene)
+    CompiledScene compiledScene;
+    if (!sceneLoader.loadCompiledScene(it->second, compiledScene)) {
+        activeScene = std::move(scene);
         return;
+    }
 
     // Carregar todos os world objects
-    sceneLoader.loadWorldObjects(activeScene->getObjectManager(), compiledScene);
+    sceneLoader.loadWorldObjects(scene->getObjectManager(), compiledScene);
 
     // Encontrar e setar a camera principal
-    for (auto& obj : activeScene->getObjectManager()->getObjects()) {
-        if (obj->hasComponent<Camera>()) {
-            activeScene->setCameraObject(obj.get());
-            break;
-        }
-    }
+    if (!scene->getCameras().empty())
+        scene->setCameraObject(scene->getCameras().front()->getOwner());
 
-    delete compiledScene;
+    activeScene = std::move(scene);
 }
 
 void SceneManager::setRendererBackend(RendererBackend& rendererBackend) {
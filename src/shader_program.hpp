@@ -1,19 +1,40 @@
 #ifndef SHADER_PROGRAM_HPP
 #define SHADER_PROGRAM_HPP
 
+#include "uniform_block.hpp"
+#include "vertex_layout.hpp"
 #include <cstddef>
+#include <cstdint>
 
 class ShaderAsset;
 
 class ShaderProgram {
+  private:
+    // Small, dense ids keep render queue sort keys compact
+    static inline uint32_t nextId = 0;
+    uint32_t id = nextId++;
+
+  protected:
+    // Vertex input the pipeline is built for; must be set before link()
+    VertexLayout vertexLayout = VertexLayout::positionNormal();
+
   public:
     virtual ~ShaderProgram() = default;
     virtual bool attachShader(const ShaderAsset& shader) = 0;
+    // May return before the driver is done; a true result only means the build was
+    // submitted. Compile and link errors are reported by isReady()
     virtual bool link() = 0;
     virtual void use() = 0;
-    virtual void setUniformBuffer(const char* name, const void* data, size_t size) = 0;
+    virtual void setUniformBuffer(UniformBlock block, const void* data, size_t size) = 0;
     virtual void* getHandle() const = 0;
     virtual bool isValid() const = 0;
+    // Polls the build started by link() without blocking, finishing it once the driver is
+    // done. Programs that are not ready must not be drawn with; failed ones never become ready
+    virtual bool isReady() { return true; }
+
+    uint32_t getId() const { return id; }
+    void setVertexLayout(const VertexLayout& layout) { vertexLayout = layout; }
+    const VertexLayout& getVertexLayout() const { return vertexLayout; }
 };
 
 #endif // SHADERPROGRAM_HPP
\ No newline at end of file
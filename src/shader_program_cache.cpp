@@ -0,0 +1,54 @@
+#include "shader_program_cache.hpp"
+
+std::shared_ptr<ShaderProgram> ShaderProgramCache::find(PathId vertexShader,
+                                                        PathId fragmentShader, GraphicsAPI api,
+                                                        const VertexLayout& layout) const {
+    auto it = programs.find(makeKey(vertexShader, fragmentShader));
+    if (it == programs.end())
+        return nullptr;
+
+    for (const auto& entry : it->second) {
+        if (entry.api == api && entry.layout == layout)
+            return entry.program.lock();
+    }
+    return nullptr;
+}
+
+void ShaderProgramCache::insert(PathId vertexShader, PathId fragmentShader, GraphicsAPI api,
+                                const VertexLayout& layout,
+                                const std::shared_ptr<ShaderProgram>& program) {
+    auto& entries = programs[makeKey(vertexShader, fragmentShader)];
+    for (auto& entry : entries) {
+        if (entry.api == api && entry.layout == layout) {
+            entry.program = program;
+            return;
+        }
+    }
+    entries.push_back(Entry{api, layout, program});
+}
+
+void ShaderProgramCache::purge() {
+    for (auto it = programs.begin(); it != programs.end();) {
+        auto& entries = it->second;
+        for (size_t i = 0; i < entries.size();) {
+            if (entries[i].program.expired()) {
+                entries[i] = entries.back();
+                entries.pop_back();
+            } else {
+                i++;
+            }
+        }
+
+        if (entries.empty())
+            it = programs.erase(it);
+        else
+            ++it;
+    }
+}
+
+size_t ShaderProgramCache::size() const {
+    size_t count = 0;
+    for (const auto& pair : programs)
+        count += pair.second.size();
+    return count;
+}
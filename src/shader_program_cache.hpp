@@ -0,0 +1,43 @@
+#ifndef SHADER_PROGRAM_CACHE_HPP
+#define SHADER_PROGRAM_CACHE_HPP
+
+#include "graphics_api.hpp"
+#include "path_table.hpp"
+#include "shader_program.hpp"
+#include "vertex_layout.hpp"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Shares linked programs between every material built from the same (vertex shader,
+// fragment shader, backend). The vertex layout is part of the key too, since pipelines
+// bake their vertex input at link time. Entries are weak, like MeshCache.
+class ShaderProgramCache {
+  private:
+    struct Entry {
+        GraphicsAPI api;
+        VertexLayout layout;
+        std::weak_ptr<ShaderProgram> program;
+    };
+
+    // Keyed by the shader pair; the few variants per pair are scanned linearly
+    std::unordered_map<uint64_t, std::vector<Entry>> programs;
+
+    static uint64_t makeKey(PathId vertexShader, PathId fragmentShader) {
+        return (static_cast<uint64_t>(vertexShader) << 32) | fragmentShader;
+    }
+
+  public:
+    // Returns nullptr when no matching program is alive
+    std::shared_ptr<ShaderProgram> find(PathId vertexShader, PathId fragmentShader,
+                                        GraphicsAPI api, const VertexLayout& layout) const;
+    void insert(PathId vertexShader, PathId fragmentShader, GraphicsAPI api,
+                const VertexLayout& layout, const std::shared_ptr<ShaderProgram>& program);
+    // Drops entries whose program has already been released
+    void purge();
+
+    size_t size() const;
+};
+
+#endif
@@ -17,7 +17,7 @@ std::unique_ptr<ShaderProgram> ShaderProgramFactory::create(GraphicsAPI api, voi
         return std::make_unique<WebGLShaderProgram>();
 #else
     case GraphicsAPI::OPENGL:
-        return std::make_unique<OpenGLShaderProgram>();
+        return std::make_unique<OpenGLShaderProgram>(static_cast<OpenGLRendererBackend*>(context));
     case GraphicsAPI::VULKAN:
         return std::make_unique<VulkanShaderProgram>(static_cast<VulkanRendererBackend*>(context));
 #ifdef _WIN32
@@ -18,7 +18,7 @@ bool Skybox::init() {
         -1.0f, 1.0f,  1.0f,  -1.0f, 1.0f,  -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f,
         1.0f,  -1.0f, -1.0f, 1.0f,  -1.0f, -1.0f, -1.0f, -1.0f, 1.0f,  1.0f,  -1.0f, 1.0f};
 
-    cubeMesh->setVertices(skyboxVertices);
+    cubeMesh->setVertices(std::move(skyboxVertices));
     cubeMesh->setNormals({});
 
     return cubeMesh->configure();
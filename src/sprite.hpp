@@ -6,6 +6,8 @@ class Sprite {
     unsigned int textureID = 0;
     float width = 1.0f;
     float height = 1.0f;
+    // u0, v0, u1, v1 of the image inside the texture, which may be a shared atlas page
+    float uvRect[4] = {0.0f, 0.0f, 1.0f, 1.0f};
 
   public:
     Sprite(float w = 1.0f, float h = 1.0f) : width(w), height(h) {}
@@ -14,6 +16,14 @@ class Sprite {
     unsigned int getTexture() const { return textureID; }
     float getWidth() const { return width; }
     float getHeight() const { return height; }
+
+    void setUVRect(float u0, float v0, float u1, float v1) {
+        uvRect[0] = u0;
+        uvRect[1] = v0;
+        uvRect[2] = u1;
+        uvRect[3] = v1;
+    }
+    const float* getUVRect() const { return uvRect; }
 };
 
 #endif
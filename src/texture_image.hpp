@@ -0,0 +1,31 @@
+#ifndef TEXTURE_IMAGE_HPP
+#define TEXTURE_IMAGE_HPP
+
+#include <cstdint>
+
+inline constexpr uint32_t TEXTURE_MAX_LEVELS = 16;
+
+enum class TextureFormat : uint8_t {
+    RGBA8 = 0, // uncompressed fallback (pixel art, sizes that are not multiples of 4)
+    BC1 = 1,   // opaque, 8 bytes per 4x4 block
+    BC3 = 2    // with alpha, 16 bytes per 4x4 block
+};
+
+struct TextureLevel {
+    uint32_t width;
+    uint32_t height;
+    const uint8_t* data;
+    uint32_t size;
+};
+
+// Non-owning view of a baked texture; level data usually points into a mapped scene
+struct TextureImage {
+    TextureFormat format = TextureFormat::RGBA8;
+    uint32_t levelCount = 0;
+    TextureLevel levels[TEXTURE_MAX_LEVELS];
+
+    uint32_t getWidth() const { return levelCount > 0 ? levels[0].width : 0; }
+    uint32_t getHeight() const { return levelCount > 0 ? levels[0].height : 0; }
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef UNIFORM_BLOCK_HPP
+#define UNIFORM_BLOCK_HPP
+
+#include <cstdint>
+#include <cstring>
+
+// Uniform blocks known to the engine. The value doubles as the binding point (GL),
+// descriptor binding (Vulkan) and root parameter index (D3D12), so no backend has to
+// look blocks up by name while drawing.
+// LIGHT_DATA is the single-light block filled by Material::applyLight;
+// CLUSTER_LIGHT_DATA is the clustered light list (ClusterLightingBlock), fed only by
+// backends that consume LightClusterGrid.
+enum class UniformBlock : uint8_t {
+    MODEL_VIEW_PROJECTION = 0,
+    MATERIAL_DATA = 1,
+    LIGHT_DATA = 2,
+    CLUSTER_LIGHT_DATA = 3
+};
+
+inline constexpr uint32_t UNIFORM_BLOCK_COUNT = 4;
+
+// Block names as declared in the shader sources
+inline const char* getUniformBlockName(UniformBlock block) {
+    static const char* const names[UNIFORM_BLOCK_COUNT] = {"ModelViewProjection", "MaterialData",
+                                                           "LightData", "ClusterLightData"};
+    return names[static_cast<uint32_t>(block)];
+}
+
+// Matches a reflected block name, returning false for blocks the engine does not feed
+inline bool findUniformBlock(const char* name, UniformBlock& block) {
+    for (uint32_t i = 0; i < UNIFORM_BLOCK_COUNT; i++) {
+        if (std::strcmp(name, getUniformBlockName(static_cast<UniformBlock>(i))) == 0) {
+            block = static_cast<UniformBlock>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef VERTEX_LAYOUT_HPP
+#define VERTEX_LAYOUT_HPP
+
+#include <cstdint>
+
+enum class VertexSemantic : uint8_t { POSITION = 0, NORMAL = 1, TEXCOORD = 2, TANGENT = 3 };
+
+enum class VertexFormat : uint8_t { FLOAT2 = 0, FLOAT3 = 1, FLOAT4 = 2 };
+
+inline uint32_t getVertexFormatComponents(VertexFormat format) {
+    return static_cast<uint32_t>(format) + 2;
+}
+
+inline uint32_t getVertexFormatSize(VertexFormat format) {
+    return getVertexFormatComponents(format) * sizeof(float);
+}
+
+struct VertexAttribute {
+    VertexSemantic semantic;
+    VertexFormat format;
+    uint32_t location; // shader input location
+    uint32_t offset;   // in bytes, from the start of the vertex
+};
+
+// Describes one interleaved vertex buffer. Attributes are appended in memory order.
+struct VertexLayout {
+    static constexpr uint32_t MAX_ATTRIBUTES = 8;
+
+    VertexAttribute attributes[MAX_ATTRIBUTES] = {};
+    uint32_t attributeCount = 0;
+    uint32_t stride = 0;
+
+    VertexLayout& add(VertexSemantic semantic, VertexFormat format, uint32_t location) {
+        if (attributeCount < MAX_ATTRIBUTES) {
+            attributes[attributeCount++] = VertexAttribute{semantic, format, location, stride};
+            stride += getVertexFormatSize(format);
+        }
+        return *this;
+    }
+
+    const VertexAttribute* find(VertexSemantic semantic) const {
+        for (uint32_t i = 0; i < attributeCount; i++) {
+            if (attributes[i].semantic == semantic)
+                return &attributes[i];
+        }
+        return nullptr;
+    }
+
+    bool operator==(const VertexLayout& other) const {
+        if (attributeCount != other.attributeCount || stride != other.stride)
+            return false;
+        for (uint32_t i = 0; i < attributeCount; i++) {
+            const auto& a = attributes[i];
+            const auto& b = other.attributes[i];
+            if (a.semantic != b.semantic || a.format != b.format || a.location != b.location ||
+                a.offset != b.offset)
+                return false;
+        }
+        return true;
+    }
+    bool operator!=(const VertexLayout& other) const { return !(*this == other); }
+
+    // Skybox cube
+    static VertexLayout position() {
+        return VertexLayout().add(VertexSemantic::POSITION, VertexFormat::FLOAT3, 0);
+    }
+
+    // Lit meshes (and the baked MESHES format)
+    static VertexLayout positionNormal() {
+        return VertexLayout()
+            .add(VertexSemantic::POSITION, VertexFormat::FLOAT3, 0)
+            .add(VertexSemantic::NORMAL, VertexFormat::FLOAT3, 1);
+    }
+
+    // Sprites
+    static VertexLayout positionTexcoord() {
+        return VertexLayout()
+            .add(VertexSemantic::POSITION, VertexFormat::FLOAT3, 0)
+            .add(VertexSemantic::TEXCOORD, VertexFormat::FLOAT2, 1);
+    }
+};
+
+#endif
@@ -6,21 +6,49 @@
 #include "sprite.hpp"
 #include "transform.hpp"
 #include <memory>
+#include <type_traits>
 #include <typeinfo>
 #include <vector>
 
+class WorldObject;
+
+// Notified whenever an object's set of components, mesh or sprite changes (see Scene)
+class WorldObjectListener {
+  public:
+    virtual ~WorldObjectListener() = default;
+    virtual void onComponentsChanged(WorldObject& obj) = 0;
+    virtual void onObjectRemoved(WorldObject& obj) = 0;
+};
+
 class WorldObject {
   private:
     Transform transform;
     std::vector<std::unique_ptr<Component>> components;
+    WorldObjectListener* listener = nullptr;
 
     // TODO: Remover uso de mesh e sprite diretamente
-    std::unique_ptr<Mesh> mesh;
+    // Shared with every other object drawing the same mesh (see MeshCache)
+    std::shared_ptr<Mesh> mesh;
     std::unique_ptr<Sprite> sprite;
 
+    template <typename T> static bool isComponentOf(const Component& comp) {
+        // Built-in components carry a kind tag, so no RTTI is needed for them
+        if constexpr (T::KIND == ComponentKind::OTHER)
+            return dynamic_cast<const T*>(&comp) != nullptr;
+        else
+            return comp.getKind() == T::KIND;
+    }
+
+    void notifyChanged() {
+        if (listener)
+            listener->onComponentsChanged(*this);
+    }
+
   public:
     WorldObject() = default;
 
+    void setListener(WorldObjectListener* l) { listener = l; }
+
     // TODO: esse gettransform poderia por baixo dos panos chamar getComponent<Transform>
     // e o transform ficar dentro do vetor de componentes ?? só teria um transform mesmo...
     Transform& getTransform();
@@ -31,14 +59,28 @@ class WorldObject {
         T* ptr = component.get();
         ptr->setOwner(this);
         components.push_back(std::move(component));
+        notifyChanged();
         return ptr;
     }
 
+    // Removes the first component of type T; returns false when there is none
+    template <typename T> bool removeComponent() {
+        static_assert(std::is_base_of<Component, T>::value, "T must inherit from Component");
+        for (auto it = components.begin(); it != components.end(); ++it) {
+            if (isComponentOf<T>(**it)) {
+                components.erase(it);
+                notifyChanged();
+                return true;
+            }
+        }
+        return false;
+    }
+
     template <typename T> T* getComponent() {
         static_assert(std::is_base_of<Component, T>::value, "T must inherit from Component");
         for (auto& comp : components) {
-            if (T* ptr = dynamic_cast<T*>(comp.get())) {
-                return ptr;
+            if (isComponentOf<T>(*comp)) {
+                return static_cast<T*>(comp.get());
             }
         }
         return nullptr;
@@ -47,8 +89,8 @@ class WorldObject {
     template <typename T> const T* getComponent() const {
         static_assert(std::is_base_of<Component, T>::value, "T must inherit from Component");
         for (auto& comp : components) {
-            if (const T* ptr = dynamic_cast<const T*>(comp.get())) {
-                return ptr;
+            if (isComponentOf<T>(*comp)) {
+                return static_cast<const T*>(comp.get());
             }
         }
         return nullptr;
@@ -57,12 +99,18 @@ class WorldObject {
     template <typename T> bool hasComponent() const { return getComponent<T>() != nullptr; }
 
     // TODO: remover suporte a legacy mesh/sprite
-    void setMesh(std::unique_ptr<Mesh> m) { mesh = std::move(m); }
+    void setMesh(std::shared_ptr<Mesh> m) {
+        mesh = std::move(m);
+        notifyChanged();
+    }
     Mesh* getMesh() { return mesh.get(); }
     const Mesh* getMesh() const { return mesh.get(); }
     bool hasMesh() const { return mesh != nullptr; }
 
-    void setSprite(std::unique_ptr<Sprite> s) { sprite = std::move(s); }
+    void setSprite(std::unique_ptr<Sprite> s) {
+        sprite = std::move(s);
+        notifyChanged();
+    }
     Sprite* getSprite() { return sprite.get(); }
     const Sprite* getSprite() const { return sprite.get(); }
     bool hasSprite() const { return sprite != nullptr; }
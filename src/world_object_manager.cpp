@@ -3,6 +3,7 @@
 WorldObject* WorldObjectManager::createObject() {
     auto obj = std::make_unique<WorldObject>();
     WorldObject* ptr = obj.get();
+    ptr->setListener(listener);
     objects.push_back(std::move(obj));
     return ptr;
 }
@@ -11,4 +12,10 @@ const std::vector<std::unique_ptr<WorldObject>>& WorldObjectManager::getObjects(
     return objects;
 }
 
-void WorldObjectManager::clear() { objects.clear(); }
\ No newline at end of file
+void WorldObjectManager::clear() {
+    if (listener) {
+        for (auto& obj : objects)
+            listener->onObjectRemoved(*obj);
+    }
+    objects.clear();
+}
\ No newline at end of file
@@ -8,10 +8,14 @@
 class WorldObjectManager {
   private:
     std::vector<std::unique_ptr<WorldObject>> objects;
+    WorldObjectListener* listener = nullptr;
 
   public:
     WorldObjectManager() = default;
 
+    // Attached to every object created afterwards
+    void setListener(WorldObjectListener* l) { listener = l; }
+
     WorldObject* createObject();
 
     const std::vector<std::unique_ptr<WorldObject>>& getObjects() const;